@@ -0,0 +1,41 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+namespace Fenrir::Bench
+{
+    /**
+     * @brief Keep a result alive so the work that made it is not optimized away
+     *
+     * @param value the result
+     */
+    inline void Keep(size_t value)
+    {
+        static volatile size_t sink = 0;
+        sink = sink + value;
+    }
+
+    /**
+     * @brief Time a case, running it once to warm up and then the given number of times, and print the mean time of
+     * one run
+     *
+     * @tparam Func the case function type
+     * @param name the name of the case
+     * @param iterations the number of timed runs
+     * @param func the case, run once per iteration
+     */
+    template <typename Func>
+    void Run(const char* name, size_t iterations, Func&& func)
+    {
+        func();
+
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i)
+            func();
+        const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::printf("%-48s %12.2f us\n", name, elapsed.count() / static_cast<double>(iterations));
+    }
+} // namespace Fenrir::Bench
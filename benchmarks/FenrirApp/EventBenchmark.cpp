@@ -0,0 +1,121 @@
+#include "Bench.hpp"
+
+#include "FenrirApp/EventQueue.hpp"
+#include "FenrirScheduler/TaskCounter.hpp"
+#include "FenrirScheduler/ThreadPool.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using namespace Fenrir;
+
+    // a raw input device reports movement many times a frame
+    struct MouseMoveEvent
+    {
+        float dx = 0.0f;
+        float dy = 0.0f;
+    };
+
+    constexpr size_t EventsPerFrame = 10000;
+    constexpr size_t ReadersPerFrame = 4;
+
+    // sends a frame of events, merges them and has every reader walk them, the way the app runs a frame
+    template <typename Read>
+    void RunFrame(EventQueue<MouseMoveEvent>& queue, uint64_t& frame, size_t slot, Read&& read)
+    {
+        for (size_t i = 0; i < EventsPerFrame; ++i)
+            queue.Send(MouseMoveEvent{1.0f, static_cast<float>(i)}, slot);
+
+        queue.Merge(++frame);
+
+        for (size_t reader = 0; reader < ReadersPerFrame; ++reader)
+            read(queue.ReadEvents(frame));
+    }
+
+    float SumView(const EventView<MouseMoveEvent>& events)
+    {
+        float sum = 0.0f;
+        for (const MouseMoveEvent& event : events)
+            sum += event.dx;
+
+        return sum;
+    }
+} // namespace
+
+int main()
+{
+    const size_t threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    {
+        EventQueue<MouseMoveEvent> queue(threads + 1);
+        uint64_t frame = 0;
+        Bench::Run("10000 events, 4 readers walking the view", 100, [&] {
+            RunFrame(queue, frame, threads, [](const EventView<MouseMoveEvent>& events) {
+                Bench::Keep(static_cast<size_t>(SumView(events)));
+            });
+        });
+    }
+
+    {
+        // what every reader paid before the view, a copy of both buffers into a combined one
+        EventQueue<MouseMoveEvent> queue(threads + 1);
+        uint64_t frame = 0;
+        std::vector<MouseMoveEvent> combined;
+        Bench::Run("10000 events, 4 readers copying first", 100, [&] {
+            RunFrame(queue, frame, threads, [&combined](const EventView<MouseMoveEvent>& events) {
+                combined.clear();
+                combined.insert(combined.end(), events.begin(), events.end());
+                float sum = 0.0f;
+                for (const MouseMoveEvent& event : combined)
+                    sum += event.dx;
+                Bench::Keep(static_cast<size_t>(sum));
+            });
+        });
+    }
+
+    {
+        EventQueue<MouseMoveEvent> queue(threads + 1);
+        queue.SetCoalescing(EventCoalescing<MouseMoveEvent>::Accumulate(
+            [](MouseMoveEvent& total, const MouseMoveEvent& event) {
+                total.dx += event.dx;
+                total.dy += event.dy;
+            }));
+        uint64_t frame = 0;
+        Bench::Run("10000 events accumulated, 4 readers", 100, [&] {
+            RunFrame(queue, frame, threads, [](const EventView<MouseMoveEvent>& events) {
+                Bench::Keep(static_cast<size_t>(SumView(events)));
+            });
+        });
+    }
+
+    {
+        // each worker stages into its own slot, only the merge puts them together
+        ThreadPool threadPool(threads);
+        EventQueue<MouseMoveEvent> queue(threads + 1);
+        uint64_t frame = 0;
+        Bench::Run("10000 events sent from the workers, merged", 100, [&] {
+            TaskCounter counter;
+            constexpr size_t tasks = 100;
+            for (size_t task = 0; task < tasks; ++task)
+            {
+                threadPool.Dispatch(
+                    [&queue, &threadPool] {
+                        const size_t slot = threadPool.GetCurrentWorkerIndex();
+                        for (size_t i = 0; i < EventsPerFrame / tasks; ++i)
+                            queue.Send(MouseMoveEvent{1.0f, static_cast<float>(i)}, slot);
+                    },
+                    counter);
+            }
+            threadPool.Wait(counter);
+
+            queue.Merge(++frame);
+            Bench::Keep(static_cast<size_t>(SumView(queue.ReadEvents(frame))));
+        });
+    }
+
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include "Bench.hpp"
+
+#include "FenrirApp/App.hpp"
+#include "FenrirLogger/ConsoleLogger.hpp"
+#include "FenrirScheduler/Scheduler.hpp"
+#include "FenrirScheduler/TaskOrder.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+namespace
+{
+    using namespace Fenrir;
+
+    enum class Kind
+    {
+        Undeclared, // one parallel batch, as systems added without access are
+        Reads,      // declared read only, also one parallel batch
+        Writes,     // every system writes the same type, so each is a batch of its own
+        Sequential  // run one after another on the calling thread
+    };
+
+    // the component type the declared systems access
+    struct Shared
+    {
+    };
+
+    void AddSystems(Scheduler& scheduler, Kind kind, size_t count, std::atomic<size_t>& calls)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            SystemFunc system = [&calls](App&) { calls.fetch_add(1, std::memory_order_relaxed); };
+            switch (kind)
+            {
+            case Kind::Undeclared:
+                scheduler.AddSystem(SchedulePriority::Update, system);
+                break;
+            case Kind::Reads:
+                scheduler.AddSystem(SchedulePriority::Update, system, SystemAccess().Reads<Shared>());
+                break;
+            case Kind::Writes:
+                scheduler.AddSystem(SchedulePriority::Update, system, SystemAccess().Writes<Shared>());
+                break;
+            case Kind::Sequential:
+                scheduler.AddSequentialSystem(SchedulePriority::Update, system);
+                break;
+            }
+        }
+    }
+
+    // one frame runs every phase the app runs each frame, only Update has any systems in it
+    void RunFrame(Scheduler& scheduler, App& app)
+    {
+        TaskOrder::SetRun(0);
+        scheduler.RunSystems(app, SchedulePriority::PreUpdate);
+        scheduler.RunSystems(app, SchedulePriority::Tick);
+        scheduler.RunSystems(app, SchedulePriority::Update);
+        scheduler.RunSystems(app, SchedulePriority::PostUpdate);
+    }
+} // namespace
+
+int main()
+{
+    App app(std::make_unique<ConsoleLogger>());
+
+    const char* kinds[] = {"undeclared", "reads", "writes", "sequential"};
+    for (const Kind kind : {Kind::Undeclared, Kind::Reads, Kind::Writes, Kind::Sequential})
+    {
+        for (const size_t count : {size_t{0}, size_t{10}, size_t{1000}})
+        {
+            Scheduler scheduler;
+            std::atomic<size_t> calls = 0;
+            AddSystems(scheduler, kind, count, calls);
+            scheduler.Finalize();
+
+            const std::string name = "frame with " + std::to_string(count) + " " + kinds[static_cast<int>(kind)];
+            Bench::Run(name.c_str(), count == 1000 ? 100 : 10000, [&] { RunFrame(scheduler, app); });
+            Bench::Keep(calls.load());
+        }
+    }
+
+    return 0;
+}
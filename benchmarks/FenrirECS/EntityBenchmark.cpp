@@ -0,0 +1,67 @@
+#include "Bench.hpp"
+
+#include "FenrirECS/Entity.hpp"
+#include "FenrirECS/EntityList.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+    using namespace Fenrir;
+
+    constexpr size_t EntityCount = 100000;
+
+    struct Velocity
+    {
+        float x = 0.0f;
+        float y = 0.0f;
+        float z = 0.0f;
+    };
+
+    std::vector<uint32_t> CreateOneAtATime(EntityList& entityList)
+    {
+        std::vector<uint32_t> ids;
+        ids.reserve(EntityCount);
+        for (size_t i = 0; i < EntityCount; ++i)
+        {
+            Entity entity = entityList.CreateEntity();
+            entity.AddComponent<Velocity>(Velocity{1.0f, 0.0f, 0.0f});
+            ids.push_back(entity.GetId());
+        }
+
+        return ids;
+    }
+
+    std::vector<uint32_t> CreateAtOnce(EntityList& entityList)
+    {
+        return entityList.CreateEntities(EntityCount, Velocity{1.0f, 0.0f, 0.0f});
+    }
+} // namespace
+
+int main()
+{
+    // each run starts from an empty list, so the list itself is made and torn down in every case
+    Bench::Run("create 100000 one at a time", 10, [] {
+        EntityList entityList;
+        Bench::Keep(CreateOneAtATime(entityList).size());
+    });
+
+    Bench::Run("create 100000 at once", 10, [] {
+        EntityList entityList;
+        Bench::Keep(CreateAtOnce(entityList).size());
+    });
+
+    Bench::Run("create and destroy 100000 one at a time", 10, [] {
+        EntityList entityList;
+        for (const uint32_t id : CreateOneAtATime(entityList))
+            entityList.DestroyEntity(id);
+    });
+
+    Bench::Run("create and destroy 100000 at once", 10, [] {
+        EntityList entityList;
+        entityList.DestroyEntities(CreateAtOnce(entityList));
+    });
+
+    return 0;
+}
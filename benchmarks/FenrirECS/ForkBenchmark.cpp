@@ -0,0 +1,86 @@
+#include "Bench.hpp"
+
+#include "FenrirECS/Entity.hpp"
+#include "FenrirECS/EntityList.hpp"
+#include "FenrirECS/EntityListFork.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+    using namespace Fenrir;
+
+    constexpr size_t EntityCount = 100000;
+
+    std::vector<uint32_t> CreateEntities(EntityList& entityList)
+    {
+        std::vector<uint32_t> ids;
+        for (size_t i = 0; i < EntityCount; ++i)
+        {
+            Entity entity = entityList.CreateEntity();
+            entity.GetComponent<Transform>().pos.x = static_cast<float>(i);
+            ids.push_back(entity.GetId());
+        }
+
+        return ids;
+    }
+
+    // writes to one in every hundred entities and marks them, as a frame of gameplay would between forks
+    void ChangeSome(EntityList& entityList, const std::vector<uint32_t>& ids)
+    {
+        for (size_t i = 0; i < ids.size(); i += 100)
+        {
+            entityList.GetEntity(ids[i]).GetComponent<Transform>().pos.y += 1.0f;
+            entityList.MarkComponentChanged<Transform>(ids[i]);
+        }
+    }
+
+    void CreateAndDestroy(EntityList& entityList)
+    {
+        std::vector<uint32_t> ids;
+        for (size_t i = 0; i < 1000; ++i)
+            ids.push_back(entityList.CreateEntity().GetId());
+        for (const uint32_t id : ids)
+            entityList.DestroyEntity(id);
+    }
+} // namespace
+
+int main()
+{
+    EntityList entityList;
+    const std::vector<uint32_t> ids = CreateEntities(entityList);
+
+    // a list that was never forked does no page bookkeeping, compare with the same loop after the first fork
+    Bench::Run("create and destroy 1000, never forked", 100, [&entityList] { CreateAndDestroy(entityList); });
+
+    Bench::Run("full fork of 100000", 20, [&entityList] {
+        Bench::Keep(EntityListFork::Create(entityList).GetCopiedPageCount());
+    });
+
+    Bench::Run("create and destroy 1000, forked", 100, [&entityList] { CreateAndDestroy(entityList); });
+
+    EntityListFork base = EntityListFork::Create(entityList);
+    Bench::Run("fork with nothing changed", 100, [&entityList, &base] {
+        base = EntityListFork::Create(entityList, &base);
+        Bench::Keep(base.GetCopiedPageCount());
+    });
+
+    Bench::Run("fork with 1% changed", 100, [&entityList, &base, &ids] {
+        ChangeSome(entityList, ids);
+        base = EntityListFork::Create(entityList, &base);
+        Bench::Keep(base.GetCopiedPageCount());
+    });
+
+    Bench::Run("restore in place with 1% changed", 100, [&entityList, &base, &ids] {
+        ChangeSome(entityList, ids);
+        Bench::Keep(base.Restore(entityList));
+    });
+
+    Bench::Run("restore after destroying an entity", 20, [&entityList, &base, &ids] {
+        entityList.DestroyEntity(ids[EntityCount / 2]);
+        Bench::Keep(base.Restore(entityList));
+    });
+
+    return 0;
+}
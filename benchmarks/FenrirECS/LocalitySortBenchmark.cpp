@@ -0,0 +1,131 @@
+#include "Bench.hpp"
+
+#include "FenrirECS/Entity.hpp"
+#include "FenrirECS/EntityList.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace
+{
+    using namespace Fenrir;
+
+    constexpr size_t EntityCount = 200000;
+
+    struct Material
+    {
+        uint32_t handle = 0;
+    };
+
+    struct Model
+    {
+        uint32_t handle = 0;
+    };
+
+    void Spawn(EntityList& entityList, std::mt19937& random, std::vector<uint32_t>& ids)
+    {
+        Entity entity = entityList.CreateEntity();
+        entity.AddComponent<Material>(Material{static_cast<uint32_t>(random() % 256)});
+        entity.AddComponent<Model>(Model{static_cast<uint32_t>(random() % 1024)});
+        ids.push_back(entity.GetId());
+    }
+
+    // destroying and spawning at random, and swapping out the model or material of some, leaves each pool in its own
+    // order, as a long session does
+    void Churn(EntityList& entityList, std::mt19937& random, std::vector<uint32_t>& ids)
+    {
+        for (size_t round = 0; round < 4; ++round)
+        {
+            std::shuffle(ids.begin(), ids.end(), random);
+            const size_t destroyed = ids.size() / 4;
+            entityList.DestroyEntities(ids.begin(), ids.begin() + static_cast<std::ptrdiff_t>(destroyed));
+            ids.erase(ids.begin(), ids.begin() + static_cast<std::ptrdiff_t>(destroyed));
+
+            while (ids.size() < EntityCount)
+                Spawn(entityList, random, ids);
+
+            for (size_t i = 0; i < ids.size() / 4; ++i)
+            {
+                Entity entity = entityList.GetEntity(ids[i]);
+                if (i % 2 == 0)
+                {
+                    entity.RemoveComponent<Model>();
+                    entity.AddComponent<Model>(Model{static_cast<uint32_t>(random() % 1024)});
+                }
+                else
+                {
+                    entity.RemoveComponent<Material>();
+                    entity.AddComponent<Material>(Material{static_cast<uint32_t>(random() % 256)});
+                }
+            }
+        }
+    }
+
+    // a step to anything but a neighbour of the last element read from the pool
+    template <typename T>
+    bool Jumped(const T*& last, const T& current)
+    {
+        const bool jumped = last != nullptr && &current != last + 1 && &current != last - 1;
+        last = &current;
+        return jumped;
+    }
+
+    // hardware counters are not portable, so the number of times a view walk leaves a follower pool's current run of
+    // memory stands in for the cache misses it causes
+    size_t CountJumps(EntityList& entityList)
+    {
+        size_t jumps = 0;
+        const Model* lastModel = nullptr;
+        const Transform* lastTransform = nullptr;
+        entityList.ForEach<Material, Model, Transform>([&](Material&, Model& model, Transform& transform) {
+            jumps += Jumped(lastModel, model);
+            jumps += Jumped(lastTransform, transform);
+        });
+
+        return jumps;
+    }
+
+    void Iterate(EntityList& entityList)
+    {
+        uint32_t sum = 0;
+        entityList.ForEach<Material, Model, Transform>([&sum](Material& material, Model& model, Transform& transform) {
+            sum += material.handle + model.handle + static_cast<uint32_t>(transform.pos.x);
+        });
+
+        Bench::Keep(sum);
+    }
+} // namespace
+
+int main()
+{
+    std::mt19937 random(42);
+    EntityList entityList;
+    std::vector<uint32_t> ids;
+    while (ids.size() < EntityCount)
+        Spawn(entityList, random, ids);
+    Churn(entityList, random, ids);
+
+    std::printf("before: %zu jumps in %zu entities\n", CountJumps(entityList), EntityCount);
+    Bench::Run("walk Material, Model, Transform before", 20, [&entityList] { Iterate(entityList); });
+
+    entityList.AddLocalitySort<Material, Model, Transform>(
+        [](const Material& lhs, const Material& rhs) { return lhs.handle < rhs.handle; });
+
+    // the maintenance pass gets 2ms a frame, as it would from the app
+    size_t frames = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t finished = 0; finished == 0; ++frames)
+        finished = entityList.RunLocalityMaintenance(0.002);
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::printf("sorted in %zu frames, %.2f ms\n", frames, elapsed.count());
+
+    std::printf("after: %zu jumps in %zu entities\n", CountJumps(entityList), EntityCount);
+    Bench::Run("walk Material, Model, Transform after", 20, [&entityList] { Iterate(entityList); });
+
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include "Bench.hpp"
+
+#include "FenrirScheduler/TaskCounter.hpp"
+#include "FenrirScheduler/ThreadPool.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <future>
+#include <vector>
+
+namespace
+{
+    using namespace Fenrir;
+
+    constexpr size_t TaskCount = 100000;
+
+    // trivial tasks, so the time is the cost of queueing, stealing and joining rather than the work
+    void DispatchFromCaller(ThreadPool& threadPool, std::atomic<size_t>& sum)
+    {
+        TaskCounter counter;
+        for (size_t i = 0; i < TaskCount; ++i)
+            threadPool.Dispatch([&sum] { sum.fetch_add(1, std::memory_order_relaxed); }, counter);
+
+        threadPool.Wait(counter);
+    }
+
+    // every worker pushes onto its own deque, the way systems split their loops into chunks
+    void DispatchFromWorkers(ThreadPool& threadPool, std::atomic<size_t>& sum)
+    {
+        constexpr size_t fanOut = 100;
+
+        TaskCounter counter;
+        for (size_t i = 0; i < TaskCount / fanOut; ++i)
+        {
+            threadPool.Dispatch(
+                [&threadPool, &sum] {
+                    TaskCounter nested;
+                    for (size_t j = 0; j < fanOut; ++j)
+                        threadPool.Dispatch([&sum] { sum.fetch_add(1, std::memory_order_relaxed); }, nested);
+
+                    threadPool.Wait(nested);
+                },
+                counter);
+        }
+
+        threadPool.Wait(counter);
+    }
+
+    void EnqueueFromCaller(ThreadPool& threadPool, std::atomic<size_t>& sum)
+    {
+        std::vector<std::future<void>> futures;
+        futures.reserve(TaskCount / 10);
+        for (size_t i = 0; i < TaskCount / 10; ++i)
+            futures.push_back(threadPool.Enqueue([&sum] { sum.fetch_add(1, std::memory_order_relaxed); }));
+
+        for (std::future<void>& future : futures)
+            future.get();
+    }
+} // namespace
+
+int main()
+{
+    // the time per run is for TaskCount tasks, or a tenth of them for Enqueue, which allocates a future per task
+    for (size_t threads = 1; threads <= 64; threads *= 2)
+    {
+        ThreadPool threadPool(threads);
+        std::atomic<size_t> sum = 0;
+        std::printf("%zu threads\n", threads);
+
+        Bench::Run("  dispatch 100000 from the caller", 10, [&] { DispatchFromCaller(threadPool, sum); });
+        Bench::Run("  dispatch 100000 from the workers", 10, [&] { DispatchFromWorkers(threadPool, sum); });
+        Bench::Run("  enqueue 10000 from the caller", 10, [&] { EnqueueFromCaller(threadPool, sum); });
+
+        Bench::Keep(sum.load());
+    }
+
+    return 0;
+}
@@ -0,0 +1,161 @@
+#include "Bench.hpp"
+
+#include "FenrirECS/Entity.hpp"
+#include "FenrirECS/EntityList.hpp"
+#include "FenrirScheduler/ThreadPool.hpp"
+#include "FenrirSpatial/LooseOctree.hpp"
+#include "FenrirSpatial/SpatialTracker.hpp"
+#include "FenrirSpatial/UniformGrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using namespace Fenrir;
+
+    constexpr size_t QueryCount = 1000;
+    constexpr float QueryRadius = 8.0f;
+
+    // the world grows with the entity count so every size has the same density, about one entity per 64 units cubed
+    float WorldHalfSize(size_t count)
+    {
+        return 2.0f * std::cbrt(static_cast<float>(count));
+    }
+
+    Math::Point RandomPoint(std::mt19937& random, float halfSize)
+    {
+        std::uniform_real_distribution<float> coordinate(-halfSize, halfSize);
+        return Math::Point(coordinate(random), coordinate(random), coordinate(random));
+    }
+
+    std::vector<RadiusQuery> MakeQueries(std::mt19937& random, float halfSize)
+    {
+        std::vector<RadiusQuery> queries;
+        for (size_t i = 0; i < QueryCount; ++i)
+            queries.push_back(RadiusQuery{RandomPoint(random, halfSize), QueryRadius});
+
+        return queries;
+    }
+
+    std::unique_ptr<SpatialIndex> MakeIndex(bool octree, float halfSize)
+    {
+        if (octree)
+            return std::make_unique<LooseOctree>(Math::Point(0.0f, 0.0f, 0.0f), halfSize, 8);
+
+        return std::make_unique<UniformGrid>(QueryRadius);
+    }
+
+    // moves a share of the entities and marks them, the way a movement system would
+    void Move(EntityList& entityList, const std::vector<uint32_t>& ids, size_t stride, std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> step(-1.0f, 1.0f);
+        for (size_t i = 0; i < ids.size(); i += stride)
+        {
+            entityList.GetEntity(ids[i]).GetComponent<Transform>().pos += Math::Vec3(step(random), step(random), 0.0f);
+            entityList.MarkComponentChanged<Transform>(ids[i]);
+        }
+    }
+
+    void RunSize(size_t count, bool octree, ThreadPool& threadPool)
+    {
+        const float halfSize = WorldHalfSize(count);
+        const std::string prefix = std::to_string(count) + (octree ? " octree " : " grid ");
+        std::mt19937 random(7);
+
+        EntityList entityList;
+        std::vector<uint32_t> ids;
+        for (size_t i = 0; i < count; ++i)
+        {
+            Entity entity = entityList.CreateEntity();
+            entity.GetComponent<Transform>().pos = RandomPoint(random, halfSize);
+            entity.AddComponent<SpatialBody>(SpatialBody{0.5f});
+            ids.push_back(entity.GetId());
+        }
+
+        const size_t iterations = count >= 1000000 ? 2 : 10;
+
+        Bench::Run((prefix + "track").c_str(), 1, [&] {
+            SpatialTracker tracker(MakeIndex(octree, halfSize));
+            tracker.Track(entityList);
+            Bench::Keep(tracker.GetIndex().GetCount());
+        });
+
+        SpatialTracker tracker(MakeIndex(octree, halfSize));
+        tracker.Track(entityList);
+
+        Bench::Run((prefix + "update, nothing moved").c_str(), iterations, [&] { tracker.Update(entityList); });
+        Bench::Run((prefix + "update, 1% moved").c_str(), iterations, [&] {
+            Move(entityList, ids, 100, random);
+            tracker.Update(entityList);
+        });
+        Bench::Run((prefix + "update, all moved").c_str(), iterations, [&] {
+            Move(entityList, ids, 1, random);
+            tracker.Update(entityList);
+        });
+
+        const std::vector<RadiusQuery> queries = MakeQueries(random, halfSize);
+        const SpatialIndex& index = tracker.GetIndex();
+        std::vector<uint32_t> results;
+        Bench::Run((prefix + "1000 radius queries").c_str(), iterations, [&] {
+            for (const RadiusQuery& query : queries)
+            {
+                results.clear();
+                index.QueryRadius(query.center, query.radius, results);
+                Bench::Keep(results.size());
+            }
+        });
+
+        std::vector<std::vector<uint32_t>> batchResults;
+        Bench::Run((prefix + "1000 radius queries, batched").c_str(), iterations, [&] {
+            index.QueryRadiusBatch(queries, batchResults, &threadPool);
+            Bench::Keep(batchResults.size());
+        });
+    }
+
+    // what every proximity query cost before there was an index, a scan of every Transform
+    void RunScan(size_t count)
+    {
+        const float halfSize = WorldHalfSize(count);
+        std::mt19937 random(7);
+
+        EntityList entityList;
+        for (size_t i = 0; i < count; ++i)
+            entityList.CreateEntity().GetComponent<Transform>().pos = RandomPoint(random, halfSize);
+
+        const std::vector<RadiusQuery> queries = MakeQueries(random, halfSize);
+        const std::string name = std::to_string(count) + " scan, 10 radius queries";
+        Bench::Run(name.c_str(), 2, [&] {
+            for (size_t i = 0; i < 10; ++i)
+            {
+                size_t found = 0;
+                const RadiusQuery& query = queries[i];
+                entityList.ForEach<Transform>([&found, &query](Transform& transform) {
+                    found += Math::DistanceSq(transform.pos, query.center) <= query.radius * query.radius;
+                });
+                Bench::Keep(found);
+            }
+        });
+    }
+} // namespace
+
+int main()
+{
+    ThreadPool threadPool(std::max(std::thread::hardware_concurrency(), 1u));
+
+    for (const size_t count : {size_t{10000}, size_t{100000}, size_t{1000000}})
+    {
+        RunScan(count);
+        RunSize(count, false, threadPool);
+        RunSize(count, true, threadPool);
+    }
+
+    return 0;
+}
@@ -53,17 +53,17 @@ void CameraController::OnMouseScroll(const MouseScrollEvent& event)
 
 void CameraController::Update(Fenrir::App& app)
 {
-    for (const auto& event : app.ReadEvents<KeyboardKeyEvent>())
+    for (const auto& event : app.ReadEvents(m_keyReader))
     {
         OnKeyPress(event);
     }
 
-    for (const auto& event : app.ReadEvents<MouseMoveEvent>())
+    for (const auto& event : app.ReadEvents(m_mouseMoveReader))
     {
         OnMouseMove(event);
     }
 
-    for (const auto& event : app.ReadEvents<MouseScrollEvent>())
+    for (const auto& event : app.ReadEvents(m_mouseScrollReader))
     {
         OnMouseScroll(event);
     }
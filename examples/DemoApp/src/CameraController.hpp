@@ -2,6 +2,7 @@
 
 #include <unordered_set>
 
+#include "FenrirApp/EventQueue.hpp"
 #include "FenrirMath/Math.hpp"
 
 namespace Fenrir
@@ -37,6 +38,10 @@ class CameraController
     std::unordered_set<int> m_pressedKeys;
 
     Fenrir::Math::Vec2 m_deltaMousePos = Fenrir::Math::Vec2(0.0f, 0.0f);
+
+    Fenrir::EventReader<KeyboardKeyEvent> m_keyReader;
+    Fenrir::EventReader<MouseMoveEvent> m_mouseMoveReader;
+    Fenrir::EventReader<MouseScrollEvent> m_mouseScrollReader;
 };
 
 #define BIND_CAMERA_CONTROLLER_FN(fn, controllerInstance) \
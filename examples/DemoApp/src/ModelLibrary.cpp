@@ -46,37 +46,50 @@ ModelLibrary::ModelLibrary(Fenrir::ILogger& logger, TextureLibrary& textureLibra
 {
 }
 
-void ModelLibrary::AddModel(const std::string& path)
+Fenrir::Handle<Model> ModelLibrary::AddModel(const std::string& path)
 {
-    if (m_models.count(path) > 0)
+    if (m_modelHandles.count(path) > 0)
     {
         m_logger.Warn("ModelLibrary::AddModel - Model already loaded: {}", path);
-        return;
+        return m_modelHandles.at(path);
     }
 
     Model model;
     LoadModel(path, model);
 
-    m_models.emplace(path, std::move(model));
+    Fenrir::Handle<Model> handle = m_models.Add(std::move(model));
+    m_modelHandles.emplace(path, handle);
+
+    return handle;
 }
 
 const Model& ModelLibrary::GetModel(const std::string& path)
 {
-    if (m_models.count(path) == 0)
+    return *m_models.Get(GetModelHandle(path));
+}
+
+const Model* ModelLibrary::GetModel(Fenrir::Handle<Model> handle) const
+{
+    return m_models.Get(handle);
+}
+
+Fenrir::Handle<Model> ModelLibrary::GetModelHandle(const std::string& path)
+{
+    if (m_modelHandles.count(path) == 0)
     {
-        m_logger.Error("ModelLibrary::GetModel - Model not loaded: {}", path);
+        m_logger.Error("ModelLibrary::GetModelHandle - Model not loaded: {}", path);
 
-        m_logger.Info("ModelLibrary::GetModel - Attempting to load model: {}", path);
+        m_logger.Info("ModelLibrary::GetModelHandle - Attempting to load model: {}", path);
 
-        AddModel(path);
+        return AddModel(path);
     }
 
-    return m_models.at(path);
+    return m_modelHandles.at(path);
 }
 
 bool ModelLibrary::HasModel(const std::string& path) const
 {
-    return m_models.count(path) > 0;
+    return m_modelHandles.count(path) > 0;
 }
 
 void ModelLibrary::LoadModel(const std::string& path, Model& model)
@@ -4,6 +4,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "FenrirCore/AssetPool.hpp"
 #include "FenrirMath/Math.hpp"
 #include "TextureLibrary.hpp"
 
@@ -55,14 +56,20 @@ class ModelLibrary
   public:
     ModelLibrary(Fenrir::ILogger& logger, TextureLibrary& textureLibrary, ShaderLibrary& shaderLibrary);
 
-    void AddModel(const std::string& path);
+    Fenrir::Handle<Model> AddModel(const std::string& path);
 
     const Model& GetModel(const std::string& path);
 
+    const Model* GetModel(Fenrir::Handle<Model> handle) const;
+
+    Fenrir::Handle<Model> GetModelHandle(const std::string& path);
+
     bool HasModel(const std::string& path) const;
 
   private:
-    std::unordered_map<std::string, Model> m_models;
+    // every model is stored once and shared by handle, the path map is only used when loading
+    Fenrir::AssetPool<Model> m_models;
+    std::unordered_map<std::string, Fenrir::Handle<Model>> m_modelHandles;
 
     Fenrir::ILogger& m_logger;
 
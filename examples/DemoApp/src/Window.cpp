@@ -148,12 +148,12 @@ void Window::OnKeyPress(const KeyboardKeyEvent& event)
 
 void Window::PostUpdate(Fenrir::App& app)
 {
-    if (app.ReadEvents<WindowCloseEvent>().size() > 0)
+    if (!app.ReadEvents<WindowCloseEvent>().empty())
     {
         app.Stop();
     }
 
-    for (const auto& event : app.ReadEvents<KeyboardKeyEvent>())
+    for (const auto& event : app.ReadEvents(m_keyReader))
     {
         OnKeyPress(event);
     }
@@ -8,6 +8,7 @@
 #include <string>
 
 #include "Events.hpp"
+#include "FenrirApp/EventQueue.hpp"
 
 namespace Fenrir
 {
@@ -40,6 +41,8 @@ class Window
     std::string m_title = "";
     int m_width = 0;
     int m_height = 0;
+
+    Fenrir::EventReader<KeyboardKeyEvent> m_keyReader;
 };
 
 #define BIND_WINDOW_SYSTEM_FN(fn, windowInstance) std::bind(&Window::fn, &windowInstance, std::placeholders::_1)
\ No newline at end of file
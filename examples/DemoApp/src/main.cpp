@@ -11,6 +11,7 @@
 #include "TextureLibrary.hpp"
 
 #include "FenrirCamera/Camera.hpp"
+#include "FenrirCore/AssetPool.hpp"
 #include "FenrirMath/Math.hpp"
 
 #include "FenrirApp/App.hpp"
@@ -21,7 +22,9 @@
 
 #include <glad/glad.h>
 
+#include <algorithm>
 #include <iostream>
+#include <tuple>
 #include <variant>
 
 #include <entt/container/dense_map.hpp>
@@ -118,12 +121,18 @@ struct Material
     entt::dense_map<std::string, MaterialProperty> properties;
 };
 
+using ModelHandle = Fenrir::Handle<Model>;
+using MaterialHandle = Fenrir::Handle<Material>;
+
 Shader myShader;
 Shader lightShader;
 
-Model backpack;
+ModelHandle backpack;
+
+ModelHandle cube;
 
-Model cube;
+// entities share materials by handle rather than each holding a copy of the property map
+Fenrir::AssetPool<Material> materials;
 
 const glm::vec3 pointLightPositions[4] = {glm::vec3(0.7f, 0.2f, 2.0f), glm::vec3(2.3f, -3.3f, -4.0f),
                                           glm::vec3(-4.0f, 2.0f, -12.0f), glm::vec3(0.0f, 0.0f, -3.0f)};
@@ -154,15 +163,22 @@ void InitLights(Fenrir::App& app)
     light3_ent.GetComponent<Fenrir::Transform>() = light3_trans;
     light4_ent.GetComponent<Fenrir::Transform>() = light4_trans;
 
-    light1_ent.AddComponent<Material>(Material{lightShader});
-    light2_ent.AddComponent<Material>(Material{lightShader});
-    light3_ent.AddComponent<Material>(Material{lightShader});
-    light4_ent.AddComponent<Material>(Material{lightShader});
+    MaterialHandle lightMaterial = materials.Add(Material{lightShader});
+
+    light1_ent.AddComponent<MaterialHandle>(lightMaterial);
+    light2_ent.AddComponent<MaterialHandle>(lightMaterial);
+    light3_ent.AddComponent<MaterialHandle>(lightMaterial);
+    light4_ent.AddComponent<MaterialHandle>(lightMaterial);
 
-    light1_ent.AddComponent<Model>(cube);
-    light2_ent.AddComponent<Model>(cube);
-    light3_ent.AddComponent<Model>(cube);
-    light4_ent.AddComponent<Model>(cube);
+    light1_ent.AddComponent<ModelHandle>(cube);
+    light2_ent.AddComponent<ModelHandle>(cube);
+    light3_ent.AddComponent<ModelHandle>(cube);
+    light4_ent.AddComponent<ModelHandle>(cube);
+
+    entityList.ClearParent(light1_ent.GetId());
+    entityList.ClearParent(light2_ent.GetId());
+    entityList.ClearParent(light3_ent.GetId());
+    entityList.ClearParent(light4_ent.GetId());
 }
 
 void InitBackpacks(Fenrir::App& app)
@@ -184,6 +200,10 @@ void InitBackpacks(Fenrir::App& app)
 
     backpack2_ent.GetComponent<Fenrir::Transform>() = backpack2Transform;
 
+    // the second backpack sits 5 units above the first and follows it around
+    entityList.ClearParent(backpack1_ent.GetId());
+    entityList.SetParent(backpack2_ent.GetId(), backpack1_ent.GetId());
+
     Material backpackMaterial = {myShader};
 
     // directional light
@@ -245,18 +265,34 @@ void InitBackpacks(Fenrir::App& app)
     // set material in shader (diffuse and specular is set as texture once above)
     backpackMaterial.properties["material.shininess"] = 32.0f; // bind diffuse map
 
-    backpack1_ent.AddComponent<Material>(backpackMaterial);
-    backpack2_ent.AddComponent<Material>(backpackMaterial);
+    MaterialHandle backpackMaterialHandle = materials.Add(std::move(backpackMaterial));
 
-    backpack1_ent.AddComponent<Model>(backpack);
-    backpack2_ent.AddComponent<Model>(backpack);
+    backpack1_ent.AddComponent<MaterialHandle>(backpackMaterialHandle);
+    backpack2_ent.AddComponent<MaterialHandle>(backpackMaterialHandle);
+
+    backpack1_ent.AddComponent<ModelHandle>(backpack);
+    backpack2_ent.AddComponent<ModelHandle>(backpack);
+}
+
+void InitLocality(Fenrir::App& app)
+{
+    Fenrir::EntityList& entityList = app.GetActiveScene().GetEntityList();
+
+    // keep the drawables grouped by material so the renderer's view and draw list walk memory in order
+    entityList.AddLocalitySort<MaterialHandle, ModelHandle, Fenrir::WorldTransform>(
+        [](const MaterialHandle& lhs, const MaterialHandle& rhs) { return lhs.index < rhs.index; });
+}
+
+void MaintainLocality(Fenrir::App& app)
+{
+    app.GetActiveScene().GetEntityList().RunLocalityMaintenance(0.0005);
 }
 
 class GLRenderer
 {
   public:
-    GLRenderer(Fenrir::ILogger& logger, Window& window, Fenrir::Camera& camera)
-        : m_logger(logger), m_window(window), m_camera(camera)
+    GLRenderer(Fenrir::ILogger& logger, Window& window, Fenrir::Camera& camera, const ModelLibrary& modelLibrary)
+        : m_logger(logger), m_window(window), m_camera(camera), m_modelLibrary(modelLibrary)
     {
     }
 
@@ -292,13 +328,38 @@ class GLRenderer
 
         Fenrir::EntityList& entityList = app.GetActiveScene().GetEntityList();
 
-        entityList.ForEach<Fenrir::Transform, Model, Material>(
-            [&](Fenrir::Transform& transform, Model& model, Material& material) {
-                material.properties["spotLight.pos"] = m_camera.pos;
-                material.properties["spotLight.direction"] = m_camera.front;
-                SetMatProps(material.shader, material);
-                DrawModel(transform, model, material.shader);
+        // sort the instances by material then model, so each material is bound once and each model's meshes are
+        // drawn back to back
+        m_drawList.clear();
+        entityList.ForEach<Fenrir::WorldTransform, ModelHandle, MaterialHandle>(
+            [&](Fenrir::WorldTransform& transform, ModelHandle model, MaterialHandle material) {
+                m_drawList.push_back({material, model, &transform});
             });
+
+        std::sort(m_drawList.begin(), m_drawList.end(), [](const DrawItem& lhs, const DrawItem& rhs) {
+            return std::tie(lhs.material.index, lhs.model.index) < std::tie(rhs.material.index, rhs.model.index);
+        });
+
+        Material* material = nullptr;
+        MaterialHandle boundMaterial;
+        for (const DrawItem& item : m_drawList)
+        {
+            if (!material || item.material != boundMaterial)
+            {
+                material = materials.Get(item.material);
+                boundMaterial = item.material;
+                if (!material)
+                    continue;
+
+                material->properties["spotLight.pos"] = m_camera.pos;
+                material->properties["spotLight.direction"] = m_camera.front;
+                SetMatProps(material->shader, *material);
+            }
+
+            const Model* model = m_modelLibrary.GetModel(item.model);
+            if (model)
+                DrawModel(*item.transform, *model, material->shader);
+        }
     }
 
     void PostUpdate(Fenrir::App& app)
@@ -310,9 +371,20 @@ class GLRenderer
     }
 
   private:
+    struct DrawItem
+    {
+        MaterialHandle material;
+        ModelHandle model;
+        const Fenrir::WorldTransform* transform;
+    };
+
     Fenrir::ILogger& m_logger;
     Window& m_window;
     Fenrir::Camera& m_camera;
+    const ModelLibrary& m_modelLibrary;
+
+    // reused every frame so building the draw list does not allocate once it has grown
+    std::vector<DrawItem> m_drawList;
 
     Fenrir::Math::Mat4 m_view;
     Fenrir::Math::Mat4 m_projection;
@@ -367,20 +439,12 @@ class GLRenderer
         }
     }
 
-    void DrawModel(Fenrir::Transform& transform, Model& model, Shader& shader)
+    void DrawModel(const Fenrir::WorldTransform& transform, const Model& model, const Shader& shader)
     {
-        Fenrir::Math::Mat4 mdl_mat = Fenrir::Math::Mat4(1.0f);
-
-        mdl_mat = Fenrir::Math::Translate(mdl_mat, transform.pos);
-
-        mdl_mat *= Fenrir::Math::Mat4Cast(transform.rot);
-
-        mdl_mat = Fenrir::Math::Scale(mdl_mat, transform.scale);
-
         shader.Use();
         shader.SetMat4("view", m_view);
         shader.SetMat4("projection", m_projection);
-        shader.SetMat4("model", mdl_mat);
+        shader.SetMat4("model", transform.matrix);
 
         for (auto& mesh : model.meshes)
         {
@@ -388,7 +452,7 @@ class GLRenderer
         }
     }
 
-    void DrawMesh(Mesh& mesh, Shader& shader)
+    void DrawMesh(const Mesh& mesh, const Shader& shader)
     {
         unsigned int diffuseNr = 1;
         unsigned int specularNr = 1;
@@ -446,12 +510,14 @@ class AssetLoader
         myShader = m_shaderLibrary.GetShader("lightedObject");
         lightShader = m_shaderLibrary.GetShader("light");
 
-        m_modelLibrary.AddModel(m_assetPath + "models/backpack/backpack.obj");
+        backpack = m_modelLibrary.AddModel(m_assetPath + "models/backpack/backpack.obj");
 
-        backpack = m_modelLibrary.GetModel(m_assetPath + "models/backpack/backpack.obj");
+        cube = m_modelLibrary.AddModel(m_assetPath + "models/cube/cube.obj");
+    }
 
-        m_modelLibrary.AddModel(m_assetPath + "models/cube/cube.obj");
-        cube = m_modelLibrary.GetModel(m_assetPath + "models/cube/cube.obj");
+    const ModelLibrary& GetModelLibrary() const
+    {
+        return m_modelLibrary;
     }
 
   private:
@@ -468,11 +534,16 @@ void Tick(Fenrir::App& app)
 {
     Fenrir::EntityList& entityList = app.GetActiveScene().GetEntityList();
 
-    entityList.ForEach<Fenrir::Transform, Model, Material>(
-        [&](Fenrir::Transform& transform, Model& model, Material& material) {
+    entityList.ParallelForEach<Fenrir::Transform, Fenrir::Hierarchy, ModelHandle, MaterialHandle>(
+        [&](Fenrir::Transform& transform, Fenrir::Hierarchy& hierarchy, ModelHandle, MaterialHandle) {
+            // children follow their parent, so only the roots need moving
+            if (hierarchy.parent != Fenrir::Hierarchy::NullParent)
+                return;
+
             Fenrir::Math::Vec3 newPos =
                 transform.pos + Fenrir::Math::Vec3(0.0f, 1.f, 0.0f) * static_cast<float>(app.GetTime().tickRate);
             transform.pos = newPos;
+            hierarchy.dirty = true;
         });
 }
 
@@ -489,24 +560,40 @@ int main()
 
     CameraController cameraController(camera, 0.1f, 3.0f);
 
-    GLRenderer glRenderer(*app.Logger().get(), window, camera);
-
     AssetLoader assetLoader(*app.Logger().get(), projectSettings.assetPath);
 
+    GLRenderer glRenderer(*app.Logger().get(), window, camera, assetLoader.GetModelLibrary());
+
+    // high rate input only matters once a frame, positions and sizes keep the latest and scrolling adds up
+    app.RegisterEvent(Fenrir::EventCoalescing<FrameBufferResizeEvent>::KeepLatest())
+        .RegisterEvent(Fenrir::EventCoalescing<WindowResizeEvent>::KeepLatest())
+        .RegisterEvent<WindowCloseEvent>()
+        .RegisterEvent(Fenrir::EventCoalescing<MouseMoveEvent>::KeepLatest())
+        .RegisterEvent(Fenrir::EventCoalescing<MouseScrollEvent>::Accumulate(
+            [](MouseScrollEvent& total, const MouseScrollEvent& next) {
+                total.xOffset += next.xOffset;
+                total.yOffset += next.yOffset;
+            }))
+        .RegisterEvent<MouseButtonEvent>()
+        .RegisterEvent<KeyboardKeyEvent>();
+
     app.AddSystems(Fenrir::SchedulePriority::PreInit, {BIND_WINDOW_SYSTEM_FN(Window::PreInit, window)})
         .AddSystems(Fenrir::SchedulePriority::Init,
                     {BIND_GL_RENDERER_FN(GLRenderer::Init, glRenderer),
-                     BIND_ASSET_LOADER_FN(AssetLoader::Init, assetLoader), InitLights, InitBackpacks})
+                     BIND_ASSET_LOADER_FN(AssetLoader::Init, assetLoader), InitLights, InitBackpacks,
+                     InitLocality})
         // .AddSystems(Fenrir::SchedulePriority::PostInit, {PostInit})
         .AddSequentialSystems(Fenrir::SchedulePriority::PreUpdate,
                               {BIND_GL_RENDERER_FN(GLRenderer::PreUpdate, glRenderer)})
         .AddSequentialSystems(Fenrir::SchedulePriority::Update,
                               {BIND_CAMERA_CONTROLLER_FN(CameraController::Update, cameraController)})
         .AddSequentialSystems(Fenrir::SchedulePriority::Update, {BIND_GL_RENDERER_FN(GLRenderer::Update, glRenderer)})
-        .AddSystems(Fenrir::SchedulePriority::Tick, {Tick})
+        .AddSystem(Fenrir::SchedulePriority::Tick, Tick,
+                   Fenrir::SystemAccess().Writes<Fenrir::Transform, Fenrir::Hierarchy>()
+                       .Reads<ModelHandle, MaterialHandle>())
         .AddSequentialSystems(Fenrir::SchedulePriority::PostUpdate,
                               {BIND_GL_RENDERER_FN(GLRenderer::PostUpdate, glRenderer),
-                               BIND_WINDOW_SYSTEM_FN(Window::PostUpdate, window)})
+                               BIND_WINDOW_SYSTEM_FN(Window::PostUpdate, window), MaintainLocality})
         .AddSystems(Fenrir::SchedulePriority::Exit,
                     {BIND_WINDOW_SYSTEM_FN(Window::Exit, window), BIND_GL_RENDERER_FN(GLRenderer::Exit, glRenderer)})
         .Run();
@@ -1,13 +1,21 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
 
+#include "EventQueue.hpp"
+#include "FenrirCore/AssetPool.hpp"
 #include "FenrirLogger/ILogger.hpp"
 #include "FenrirScene/Scene.hpp"
+#include "FenrirScene/SceneStream.hpp"
 #include "FenrirScheduler/Scheduler.hpp"
 #include "FenrirTime/Time.hpp"
 
-#include <typeindex>
 #include <unordered_map>
 #include <vector>
 
@@ -15,75 +23,23 @@ namespace Fenrir
 {
 
     /**
-     * @brief Interface for event queues
-     * This is needed because we need to store different event queues in a single container
-     */
-    struct IEventQueue
-    {
-        /**
-         * @brief Destroy the IEventQueue object
-         *
-         */
-        virtual ~IEventQueue() = default;
-
-      public:
-        /**
-         * @brief update the event queue
-         *
-         */
-        virtual void Update() = 0;
-    };
-
-    /**
-     * @brief A queue for events of a specific type
+     * @brief Timings of a scene run by App::AddRunningScene, updated every frame
      *
-     * @tparam TEvent the type of event
      */
-    template <typename TEvent>
-    class EventQueue : public IEventQueue
+    struct SceneStats
     {
-      public:
-        /**
-         * @brief Send an event to the queue
-         *
-         * @param event the event
-         */
-        void Send(const TEvent& event)
-        {
-            currentBuffer.push_back(event);
-        }
-
-        /**
-         * @brief Update the event queue
-         *
-         */
-        void Update() override
-        {
-            // clear the buffer that is two frames old
-            previousBuffer.clear();
+        // seconds spent running the tick systems of the scene in the last frame, other scenes run on the same thread
+        // while it waited on split off work are left out
+        double tickTime = 0.0;
 
-            // swap the buffers: current becomes previous, and previous becomes the new current
-            std::swap(currentBuffer, previousBuffer);
-        }
+        // seconds spent updating world transforms and running the update systems in the last frame, left out the same
+        double updateTime = 0.0;
 
-        /**
-         * @brief Read the events from the queue
-         *
-         * @return const std::vector<TEvent>& the events
-         */
-        const std::vector<TEvent>& ReadEvents() const
-        {
-            // combine both current and previous buffers for reading
-            combinedBuffer.clear();
-            combinedBuffer.insert(combinedBuffer.end(), previousBuffer.begin(), previousBuffer.end());
-            combinedBuffer.insert(combinedBuffer.end(), currentBuffer.begin(), currentBuffer.end());
-            return combinedBuffer;
-        }
+        // the number of ticks run in the last frame
+        uint32_t ticks = 0;
 
-      private:
-        std::vector<TEvent> currentBuffer;
-        std::vector<TEvent> previousBuffer;
-        mutable std::vector<TEvent> combinedBuffer; // marked as mutable because ReadEvents() is const
+        // the number of frames the scene has been run for
+        uint64_t frames = 0;
     };
 
     /**
@@ -104,7 +60,8 @@ namespace Fenrir
         App(std::unique_ptr<ILogger> logger);
 
         /**
-         * @brief Add systems to the scheduler that run in parallel
+         * @brief Add systems to the scheduler without declared access, they run in parallel with each other as they
+         * always have but never alongside a system that declared its access
          *
          * @param priority the priority of the systems
          * @param systems the system functions
@@ -123,6 +80,8 @@ namespace Fenrir
 
         /**
          * @brief Add a system to the scheduler
+         * Its access is unknown, so it runs in parallel with other systems added without access but never alongside
+         * one that declared its access
          *
          * @param priority the priority of the system
          * @param system the system function
@@ -130,6 +89,17 @@ namespace Fenrir
          */
         App& AddSystem(SchedulePriority priority, SystemFunc system);
 
+        /**
+         * @brief Add a system to the scheduler with the component types it reads and writes
+         * The system runs in parallel with any system it does not conflict with
+         *
+         * @param priority the priority of the system
+         * @param system the system function
+         * @param access the component types the system reads and writes
+         * @return App& the app
+         */
+        App& AddSystem(SchedulePriority priority, SystemFunc system, SystemAccess access);
+
         /**
          * @brief Get the Logger object
          *
@@ -150,7 +120,29 @@ namespace Fenrir
         void Stop();
 
         /**
-         * @brief Send an event to the event queue
+         * @brief Register an event type, giving it an id and creating its queue now rather than the first time an
+         * event of the type is sent or read
+         *
+         * @tparam TEvent the type of event
+         * @return App& the app
+         */
+        template <typename TEvent>
+        App& RegisterEvent();
+
+        /**
+         * @brief Register an event type with a policy for coalescing the events sent in the same frame, this must be
+         * called before any events of the type are sent
+         *
+         * @tparam TEvent the type of event
+         * @param coalescing the coalescing policy
+         * @return App& the app
+         */
+        template <typename TEvent>
+        App& RegisterEvent(EventCoalescing<TEvent> coalescing);
+
+        /**
+         * @brief Send an event to the event queue, it can be read from the next frame on. This is safe to call from
+         * parallel systems and does not take a lock from inside the thread pool
          *
          * @tparam TEvent the type of event
          * @param event the event
@@ -159,13 +151,24 @@ namespace Fenrir
         void SendEvent(const TEvent& event);
 
         /**
-         * @brief Read the events from the queue
+         * @brief Read the events from the queue without copying them, events stay for two frames so a system that
+         * reads every frame sees each one twice, use an EventReader to see them once
+         *
+         * @tparam TEvent the type of event
+         * @return EventView<TEvent> the events sent in the last two frames, valid until the frame ends
+         */
+        template <typename TEvent>
+        EventView<TEvent> ReadEvents() const;
+
+        /**
+         * @brief Read the events a reader has not seen yet, so a system that reads every frame sees each event once
          *
          * @tparam TEvent the type of event
-         * @return const std::vector<TEvent>& the events
+         * @param reader the reader of the calling system, moved past the events returned
+         * @return EventView<TEvent> the unseen events, valid until the frame ends
          */
         template <typename TEvent>
-        const std::vector<TEvent>& ReadEvents() const;
+        EventView<TEvent> ReadEvents(EventReader<TEvent>& reader) const;
 
         /**
          * @brief Get the Time object
@@ -174,34 +177,215 @@ namespace Fenrir
          */
         const Time& GetTime() const;
 
+        /**
+         * @brief Get the active scene, the reference stays valid until the scene is destroyed
+         *
+         * @return Scene& the active scene
+         */
         Scene& GetActiveScene();
 
+        /**
+         * @brief Get the handle of the active scene
+         *
+         * @return SceneHandle the handle of the active scene
+         */
+        SceneHandle GetActiveSceneHandle() const;
+
         void ChangeActiveScene(const std::string& name);
 
+        /**
+         * @brief Change the active scene
+         *
+         * @param handle the handle of the scene
+         */
+        void ChangeActiveScene(SceneHandle handle);
+
+        /**
+         * @brief Create a scene, scenes are never moved once created so references to them stay valid
+         *
+         * @param name the name of the scene, which must be unique
+         * @return Scene& the scene, or the existing scene if one already has the name
+         */
         Scene& CreateScene(const std::string& name);
 
         void DestroyScene(const std::string& name);
 
+        /**
+         * @brief Destroy a scene, the active scene can not be destroyed
+         *
+         * @param handle the handle of the scene
+         */
+        void DestroyScene(SceneHandle handle);
+
         Scene& GetScene(const std::string& name);
 
+        /**
+         * @brief Get a scene from its handle
+         *
+         * @param handle the handle of the scene
+         * @return Scene* the scene, or nullptr if it has been destroyed
+         */
+        Scene* GetScene(SceneHandle handle);
+
+        /**
+         * @brief Find the handle of a scene by its name
+         *
+         * @param name the name of the scene
+         * @return SceneHandle the handle, which is not set if no scene has the name
+         */
+        SceneHandle FindScene(const std::string& name) const;
+
+        /**
+         * @brief Rename a scene, scenes owned by the app must be renamed through here to keep the name index correct
+         *
+         * @param handle the handle of the scene
+         * @param name the new name, which must be unique
+         */
+        void RenameScene(SceneHandle handle, const std::string& name);
+
+        /**
+         * @brief Stream entities into a scene over the coming frames
+         * The chunks are built on the thread pool and committed at the start of each frame within the streaming
+         * budget, so a large load never stalls a single frame
+         *
+         * @param scene the handle of the scene to load into
+         * @param count the number of entities to build
+         * @param chunkSize the number of entities built and committed at once
+         * @param build the function that builds each chunk
+         * @return std::shared_ptr<const SceneStream> the stream, used to check progress, or nullptr if the scene does
+         * not exist
+         */
+        std::shared_ptr<const SceneStream> StreamScene(SceneHandle scene, size_t count, size_t chunkSize,
+                                                       SceneChunkFunc build);
+
+        /**
+         * @brief Run a scene alongside the other running scenes
+         * While any scene is running the Tick and Update phases are run once per running scene instead of once for
+         * the app, with each scene on its own thread and GetActiveScene returning that scene to its systems and to any
+         * ParallelForEach chunks they split off, whichever thread runs them. The scenes must not share mutable state,
+         * since their systems run at the same time. The other phases still run once against the active scene
+         *
+         * @param handle the handle of the scene
+         */
+        void AddRunningScene(SceneHandle handle);
+
+        /**
+         * @brief Stop running a scene, the app goes back to only updating the active scene once none are left. Like
+         * AddRunningScene it must not be called from a Tick or Update system while scenes are running
+         *
+         * @param handle the handle of the scene
+         */
+        void RemoveRunningScene(SceneHandle handle);
+
+        /**
+         * @brief Get the timings of a running scene
+         *
+         * @param handle the handle of the scene
+         * @return const SceneStats* the timings, or nullptr if the scene is not running
+         */
+        const SceneStats* GetSceneStats(SceneHandle handle) const;
+
+        /**
+         * @brief Set the time each frame may spend committing streamed chunks, shared between every stream
+         *
+         * @param budget the budget in seconds
+         */
+        void SetStreamingBudget(double budget);
+
       private:
         Time m_time;
         Scheduler m_scheduler;
         std::unique_ptr<ILogger> m_logger;
         bool m_running = true;
 
-        std::vector<Scene> m_scenes;
-        size_t activeSceneIndex = 0;
+        AssetPool<Scene> m_scenes;
+        std::unordered_map<std::string, SceneHandle> m_sceneNames;
+        SceneHandle m_activeScene;
 
-        // this is mutable because GetEventQueue() is const
-        mutable std::unordered_map<std::type_index, std::unique_ptr<IEventQueue>> m_eventQueues;
+        // cached so getting the active scene, which every system does every frame, is a single load
+        Scene* m_activeScenePtr = nullptr;
+
+        struct PendingStream
+        {
+            SceneHandle scene;
+            std::shared_ptr<SceneStream> stream;
+        };
+
+        struct RunningScene
+        {
+            SceneHandle handle;
+            Scene* scene = nullptr;
+            SceneStats stats;
+        };
+
+        std::vector<RunningScene> m_runningScenes;
+
+        std::vector<PendingStream> m_streams;
+        double m_streamingBudget = 0.002;
+
+        static constexpr uint32_t MaxEventTypes = 1024;
+
+        // indexed by event type id so looking up a queue never takes a lock, these are mutable because
+        // GetEventQueue() is const
+        mutable std::array<std::atomic<IEventQueue*>, MaxEventTypes> m_eventQueues;
+        mutable std::vector<std::unique_ptr<IEventQueue>> m_ownedEventQueues;
+        mutable std::mutex m_eventQueueMutex; // guards creating queues
+
+        // the number of frames the event queues have been updated for
+        uint64_t m_eventFrame = 0;
 
         /**
-         * @brief Update the event queues
+         * @brief Move on to the next frame and merge the events sent during the last one, called once no systems are
+         * running
          *
          */
         void UpdateEvents();
 
+        /**
+         * @brief Play back the commands recorded by systems into every scene's command buffers and advance each
+         * scene's change tick, called after each phase once no systems are running
+         *
+         */
+        void FlushCommands();
+
+        /**
+         * @brief Recompute the world matrices of every scene's transform hierarchy, called once the tick systems have
+         * moved things and before the update systems draw them
+         *
+         */
+        void UpdateWorldTransforms();
+
+        /**
+         * @brief Commit the chunks of every stream that are ready within the streaming budget, and drop streams once
+         * they are finished
+         *
+         */
+        void CommitStreams();
+
+        /**
+         * @brief Run the Tick and Update phases of every running scene at the same time on the thread pool
+         *
+         * @param ticks the number of ticks to run
+         */
+        void RunScenes(uint32_t ticks);
+
+        /**
+         * @brief Run the Tick and Update phases of a single running scene, called on a worker thread
+         *
+         * @param running the scene to run
+         * @param ticks the number of ticks to run
+         * @param run the TaskOrder run of the scene's first tick, each phase it runs takes the next run after it
+         */
+        void RunScene(RunningScene& running, uint32_t ticks, uint32_t run);
+
+        /**
+         * @brief Get the number of ticks the rest of the frame has TaskOrder runs left for, after keeping back the runs
+         * of the phases that follow the ticks. Ticks past it stay in the accumulator for the next frame
+         *
+         * @return uint32_t the number of ticks
+         */
+        uint32_t GetMaxTicks() const;
+
         /**
          * @brief Get the Event Queue object
          *
@@ -212,32 +396,64 @@ namespace Fenrir
         EventQueue<TEvent>& GetEventQueue() const;
     };
 
+    template <typename TEvent>
+    App& App::RegisterEvent()
+    {
+        GetEventQueue<TEvent>();
+        return *this;
+    }
+
+    template <typename TEvent>
+    App& App::RegisterEvent(EventCoalescing<TEvent> coalescing)
+    {
+        GetEventQueue<TEvent>().SetCoalescing(std::move(coalescing));
+        return *this;
+    }
+
     template <typename TEvent>
     void App::SendEvent(const TEvent& event)
     {
-        GetEventQueue<TEvent>().Send(event);
+        GetEventQueue<TEvent>().Send(event, m_scheduler.GetThreadPool().GetCurrentWorkerIndex());
+    }
+
+    template <typename TEvent>
+    EventView<TEvent> App::ReadEvents() const
+    {
+        return GetEventQueue<TEvent>().ReadEvents(m_eventFrame);
     }
 
     template <typename TEvent>
-    const std::vector<TEvent>& App::ReadEvents() const
+    EventView<TEvent> App::ReadEvents(EventReader<TEvent>& reader) const
     {
-        return GetEventQueue<TEvent>().ReadEvents();
+        return GetEventQueue<TEvent>().ReadEvents(m_eventFrame, reader);
     }
 
     template <typename TEvent>
     EventQueue<TEvent>& App::GetEventQueue() const
     {
-        auto type = std::type_index(typeid(TEvent));
-        auto it = m_eventQueues.find(type);
-        if (it == m_eventQueues.end())
+        const uint32_t id = GetEventTypeId<TEvent>();
+        if (id >= MaxEventTypes)
         {
-            auto inserted = m_eventQueues.emplace(type, std::make_unique<EventQueue<TEvent>>());
-            if (!inserted.second)
+            m_logger->Error("Too many event types to create an event queue for type: " +
+                            std::string(typeid(TEvent).name()));
+            throw std::length_error("too many event types");
+        }
+
+        IEventQueue* queue = m_eventQueues[id].load(std::memory_order_acquire);
+        if (!queue)
+        {
+            // another thread may have created it while this one waited for the lock
+            std::lock_guard<std::mutex> lock(m_eventQueueMutex);
+            queue = m_eventQueues[id].load(std::memory_order_relaxed);
+            if (!queue)
             {
-                m_logger->Error("Failed to create an event queue for type: " + std::string(typeid(TEvent).name()));
+                const size_t slotCount = m_scheduler.GetThreadPool().GetThreadCount() + 1;
+                m_ownedEventQueues.push_back(std::make_unique<EventQueue<TEvent>>(slotCount));
+                queue = m_ownedEventQueues.back().get();
+                m_eventQueues[id].store(queue, std::memory_order_release);
             }
-            it = inserted.first;
         }
-        return *static_cast<EventQueue<TEvent>*>(it->second.get());
+
+        return *static_cast<EventQueue<TEvent>*>(queue);
     }
 } // namespace Fenrir
\ No newline at end of file
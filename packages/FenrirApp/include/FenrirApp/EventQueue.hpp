@@ -0,0 +1,481 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "EventView.hpp"
+#include "FenrirScheduler/TaskOrder.hpp"
+
+namespace Fenrir
+{
+    /**
+     * @brief Get the next unused event type id, ids are handed out in order starting from zero
+     *
+     * @return uint32_t the id
+     */
+    uint32_t NextEventTypeId();
+
+    /**
+     * @brief Get the id of an event type, used to index the app's event queues. The id is handed out the first time
+     * it is asked for, so registering event types at startup gives them the lowest ids
+     *
+     * @tparam TEvent the type of event
+     * @return uint32_t the id
+     */
+    template <typename TEvent>
+    uint32_t GetEventTypeId()
+    {
+        static const uint32_t id = NextEventTypeId();
+        return id;
+    }
+
+    /**
+     * @brief Base for event queues
+     * This is needed because we need to store different event queues in a single container. The merge is not
+     * virtual, each queue stores the typed function that merges it, and only queues that have had events sent are
+     * merged, once a frame
+     */
+    struct IEventQueue
+    {
+        /**
+         * @brief a function that merges a queue of a known event type
+         *
+         */
+        using MergeFunction = void (*)(IEventQueue& queue, uint64_t frame);
+
+        /**
+         * @brief Construct a new IEventQueue object
+         *
+         * @param merge the function that merges the queue
+         */
+        explicit IEventQueue(MergeFunction merge) : merge(merge)
+        {
+        }
+
+        /**
+         * @brief Destroy the IEventQueue object
+         *
+         */
+        virtual ~IEventQueue() = default;
+
+        /**
+         * @brief Move the events sent since the last merge into the buffer of a frame. This must only be called while
+         * nothing is sending or reading events
+         *
+         * @param frame the frame the events become readable in
+         */
+        void Merge(uint64_t frame)
+        {
+            merge(*this, frame);
+        }
+
+        /**
+         * @brief Check if any events have been sent since the last merge
+         *
+         * @return true if there are events to merge
+         */
+        bool HasStaged() const
+        {
+            return staged.load(std::memory_order_relaxed);
+        }
+
+      protected:
+        std::atomic<bool> staged = false;
+
+      private:
+        MergeFunction merge;
+    };
+
+    template <typename TEvent>
+    class EventQueue;
+
+    /**
+     * @brief How many events of one type sent in the same frame are squashed together as they are sent, so a device
+     * that fires hundreds of events a frame does not fill the queue. Events are combined in the order of the work
+     * that sent them and then the order each piece of work sent them in, the same order they would be read in, so the
+     * result is the same every run and the latest event is the one sent last
+     *
+     * @tparam TEvent the type of event
+     */
+    template <typename TEvent>
+    struct EventCoalescing
+    {
+        enum class Mode
+        {
+            None,        // every event is kept
+            KeepLatest,  // only the last event of each frame is kept
+            Accumulate,  // each frame's events are folded into one with the accumulate function
+            DedupeByKey, // only the last event of each frame with the same key is kept
+        };
+
+        Mode mode = Mode::None;
+
+        // adds the second event into the first, used by Accumulate
+        std::function<void(TEvent&, const TEvent&)> accumulate;
+
+        // the key of an event, used by DedupeByKey
+        std::function<uint64_t(const TEvent&)> key;
+
+        /**
+         * @brief Keep only the last event of each frame, for events that carry absolute state such as a position
+         *
+         * @return EventCoalescing the policy
+         */
+        static EventCoalescing KeepLatest()
+        {
+            EventCoalescing coalescing;
+            coalescing.mode = Mode::KeepLatest;
+            return coalescing;
+        }
+
+        /**
+         * @brief Fold each frame's events into one, for events that carry deltas such as a scroll offset
+         *
+         * @param accumulate to add the second event into the first
+         * @return EventCoalescing the policy
+         */
+        static EventCoalescing Accumulate(std::function<void(TEvent&, const TEvent&)> accumulate)
+        {
+            EventCoalescing coalescing;
+            coalescing.mode = Mode::Accumulate;
+            coalescing.accumulate = std::move(accumulate);
+            return coalescing;
+        }
+
+        /**
+         * @brief Keep only the last event of each frame with the same key, for events about many things where only
+         * the latest state of each matters
+         *
+         * @param key to get the key of an event
+         * @return EventCoalescing the policy
+         */
+        static EventCoalescing DedupeByKey(std::function<uint64_t(const TEvent&)> key)
+        {
+            EventCoalescing coalescing;
+            coalescing.mode = Mode::DedupeByKey;
+            coalescing.key = std::move(key);
+            return coalescing;
+        }
+    };
+
+    /**
+     * @brief A cursor into the events of one type, so a system that reads every frame only sees each event once. Each
+     * event gets an index that only goes up, and the reader remembers the index after the last event it read. A
+     * reader belongs to one system and must not be shared between systems that run at the same time
+     *
+     * @tparam TEvent the type of event
+     */
+    template <typename TEvent>
+    class EventReader
+    {
+      public:
+        /**
+         * @brief Get the index of the next event this reader will see
+         *
+         * @return uint64_t the index
+         */
+        uint64_t GetCursor() const
+        {
+            return cursor;
+        }
+
+      private:
+        uint64_t cursor = 0;
+
+        friend class EventQueue<TEvent>;
+    };
+
+    /**
+     * @brief A queue for events of a specific type
+     * Sent events are staged in a buffer per thread without taking a lock, apart from threads outside the thread pool
+     * which share one locked buffer. At the end of each frame the staged events are merged into a single buffer,
+     * ordered by the scheduled work that sent them and then by the order they were sent in, so the result is the
+     * same every run. Events are readable for the two frames after the one they were sent in, and reading never
+     * changes the queue so it is safe from any number of threads at once
+     *
+     * @tparam TEvent the type of event
+     */
+    template <typename TEvent>
+    class EventQueue : public IEventQueue
+    {
+      public:
+        /**
+         * @brief Construct a new Event Queue object
+         *
+         * @param slotCount the number of staging buffers, one per worker thread plus one shared by other threads
+         */
+        EventQueue(size_t slotCount) : IEventQueue(&MergeQueue), slots(std::max<size_t>(slotCount, 1))
+        {
+        }
+
+        /**
+         * @brief Set how events are coalesced as they are sent, this must be set before any events are sent
+         *
+         * @param policy the coalescing policy
+         */
+        void SetCoalescing(EventCoalescing<TEvent> policy)
+        {
+            coalescing = std::move(policy);
+        }
+
+        /**
+         * @brief Send an event to the queue, it becomes readable after the end of the frame
+         *
+         * @param event the event
+         * @param slot the worker index of the calling thread, anything past the last worker uses the shared buffer
+         */
+        void Send(const TEvent& event, size_t slot)
+        {
+            const uint64_t order = TaskOrder::Current();
+
+            if (slot >= slots.size() - 1)
+            {
+                std::lock_guard<std::mutex> lock(sharedMutex);
+                Stage(slots.back(), order, event);
+            }
+            else
+            {
+                Stage(slots[slot], order, event);
+            }
+
+            if (!staged.load(std::memory_order_relaxed))
+                staged.store(true, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Move the events sent since the last merge into the buffer of a frame. This must only be called while
+         * nothing is sending or reading events
+         *
+         * @param frame the frame the events become readable in
+         */
+        void Merge(uint64_t frame)
+        {
+            Buffer& target = buffers[frame & 1];
+            if (target.frame != frame)
+            {
+                target.events.clear();
+                mergedKeys.clear();
+                target.frame = frame;
+                target.first = eventCount;
+            }
+
+            pending.clear();
+            for (size_t slot = 0; slot < slots.size(); ++slot)
+            {
+                const std::vector<StagedEvent>& events = slots[slot].events;
+                for (size_t index = 0; index < events.size(); ++index)
+                {
+                    pending.push_back({events[index].order, events[index].sequence, static_cast<uint32_t>(slot),
+                                       static_cast<uint32_t>(index)});
+                }
+            }
+
+            std::sort(pending.begin(), pending.end(), [](const PendingEvent& lhs, const PendingEvent& rhs) {
+                return std::tie(lhs.order, lhs.slot, lhs.sequence) < std::tie(rhs.order, rhs.slot, rhs.sequence);
+            });
+
+            // the staged events were only coalesced within each thread, so they are coalesced again across threads
+            const size_t before = target.events.size();
+            for (const PendingEvent& event : pending)
+                Append(target.events, slots[event.slot].events[event.index].event);
+
+            eventCount += target.events.size() - before;
+
+            for (Slot& slot : slots)
+            {
+                slot.events.clear();
+                slot.keys.clear();
+                slot.sent = 0;
+            }
+
+            staged.store(false, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Read the events from the queue, the previous frame's followed by the current frame's
+         *
+         * @param frame the current frame
+         * @return EventView<TEvent> a view over both buffers, valid until the next merge
+         */
+        EventView<TEvent> ReadEvents(uint64_t frame) const
+        {
+            // a buffer that was last merged into more than two frames ago holds nothing readable
+            const Buffer& previous = buffers[(frame - 1) & 1];
+            const Buffer& current = buffers[frame & 1];
+
+            return EventView<TEvent>(previous.frame + 1 == frame ? std::span<const TEvent>(previous.events)
+                                                                 : std::span<const TEvent>(),
+                                     current.frame == frame ? std::span<const TEvent>(current.events)
+                                                            : std::span<const TEvent>());
+        }
+
+        /**
+         * @brief Read the events a reader has not seen yet and move the reader past them. Events that were dropped
+         * before the reader got to them, because it did not read for two frames, are skipped
+         *
+         * @param frame the current frame
+         * @param reader the reader
+         * @return EventView<TEvent> the unseen events, valid until the next merge
+         */
+        EventView<TEvent> ReadEvents(uint64_t frame, EventReader<TEvent>& reader) const
+        {
+            const EventView<TEvent> all = ReadEvents(frame);
+            std::span<const TEvent> first = all.GetFirst();
+            std::span<const TEvent> second = all.GetSecond();
+
+            // each span is trimmed to the events at or past the cursor
+            const uint64_t firstStart = buffers[(frame - 1) & 1].first;
+            const uint64_t secondStart = buffers[frame & 1].first;
+            if (reader.cursor > firstStart)
+                first = first.subspan(std::min<uint64_t>(reader.cursor - firstStart, first.size()));
+            if (reader.cursor > secondStart)
+                second = second.subspan(std::min<uint64_t>(reader.cursor - secondStart, second.size()));
+
+            reader.cursor = eventCount;
+            return EventView<TEvent>(first, second);
+        }
+
+        /**
+         * @brief Get the number of events that have been merged into the queue, which is the index the next merged
+         * event will get
+         *
+         * @return uint64_t the number of events
+         */
+        uint64_t GetEventCount() const
+        {
+            return eventCount;
+        }
+
+      private:
+        struct StagedEvent
+        {
+            uint64_t order;    // the TaskOrder key of the work that sent the event
+            uint64_t sequence; // how many events the slot had been sent before this one
+            TEvent event;
+        };
+
+        // each on its own cache line so threads sending at the same time do not contend
+        struct alignas(64) Slot
+        {
+            std::vector<StagedEvent> events;
+            std::unordered_map<uint64_t, size_t> keys; // the index of each key's event, used by DedupeByKey
+            uint64_t sent = 0;
+        };
+
+        struct PendingEvent
+        {
+            uint64_t order;
+            uint64_t sequence;
+            uint32_t slot;
+            uint32_t index;
+        };
+
+        struct Buffer
+        {
+            std::vector<TEvent> events;
+            uint64_t frame = 0; // the frame the events were merged for
+            uint64_t first = 0; // the index of the first event
+        };
+
+        EventCoalescing<TEvent> coalescing;
+        std::vector<Slot> slots;
+        std::mutex sharedMutex; // guards the last slot, which every thread outside the pool shares
+        std::vector<PendingEvent> pending; // reused between merges
+        Buffer buffers[2];                 // indexed by the parity of their frame
+
+        // the index of each key's event in the buffer being merged into, used by DedupeByKey
+        std::unordered_map<uint64_t, size_t> mergedKeys;
+        uint64_t eventCount = 0;
+
+        using Mode = typename EventCoalescing<TEvent>::Mode;
+
+        static void MergeQueue(IEventQueue& queue, uint64_t frame)
+        {
+            static_cast<EventQueue&>(queue).Merge(frame);
+        }
+
+        /**
+         * @brief Stage an event in a thread's buffer, coalescing it with what is already there. Events from later
+         * scheduled work win over earlier ones and events from the same work win in the order they were sent, and
+         * only events from the same work are accumulated together, so which thread ran the work does not change the
+         * result
+         *
+         * @param slot the thread's staging buffer
+         * @param order the TaskOrder key of the calling work
+         * @param event the event
+         */
+        void Stage(Slot& slot, uint64_t order, const TEvent& event)
+        {
+            std::vector<StagedEvent>& events = slot.events;
+            const uint64_t sequence = slot.sent++;
+
+            if (coalescing.mode == Mode::KeepLatest && !events.empty())
+            {
+                if (order >= events.front().order)
+                    events.front() = {order, sequence, event};
+                return;
+            }
+
+            if (coalescing.mode == Mode::Accumulate && !events.empty() && events.back().order == order)
+            {
+                coalescing.accumulate(events.back().event, event);
+                return;
+            }
+
+            if (coalescing.mode == Mode::DedupeByKey)
+            {
+                auto [it, inserted] = slot.keys.try_emplace(coalescing.key(event), events.size());
+                if (!inserted)
+                {
+                    if (order >= events[it->second].order)
+                        events[it->second] = {order, sequence, event};
+                    return;
+                }
+            }
+
+            events.push_back({order, sequence, event});
+        }
+
+        /**
+         * @brief Append an event to a frame's buffer in merge order, coalescing it with the events already merged
+         *
+         * @param events the frame's events
+         * @param event the event
+         */
+        void Append(std::vector<TEvent>& events, const TEvent& event)
+        {
+            if (coalescing.mode == Mode::KeepLatest && !events.empty())
+            {
+                events.back() = event;
+                return;
+            }
+
+            if (coalescing.mode == Mode::Accumulate && !events.empty())
+            {
+                coalescing.accumulate(events.back(), event);
+                return;
+            }
+
+            if (coalescing.mode == Mode::DedupeByKey)
+            {
+                auto [it, inserted] = mergedKeys.try_emplace(coalescing.key(event), events.size());
+                if (!inserted)
+                {
+                    events[it->second] = event;
+                    return;
+                }
+            }
+
+            events.push_back(event);
+        }
+    };
+} // namespace Fenrir
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <span>
+
+namespace Fenrir
+{
+    /**
+     * @brief A read only view of the events in an event queue, made of the previous frame's buffer followed by the
+     * current frame's buffer. It points straight into the queue so nothing is copied, and it is only valid until the
+     * queue's next merge, which App::UpdateEvents runs at the end of the frame. Sending does not touch the buffers it
+     * points into
+     *
+     * @tparam TEvent the type of event
+     */
+    template <typename TEvent>
+    class EventView
+    {
+      public:
+        /**
+         * @brief Iterates the first buffer and then the second as if they were one
+         *
+         */
+        class Iterator
+        {
+          public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = TEvent;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const TEvent*;
+            using reference = const TEvent&;
+
+            Iterator() = default;
+
+            /**
+             * @brief Construct a new Iterator object
+             *
+             * @param current the event it points at
+             * @param firstEnd the end of the first buffer, where it jumps to the second
+             * @param secondBegin the start of the second buffer
+             */
+            Iterator(const TEvent* current, const TEvent* firstEnd, const TEvent* secondBegin)
+                : m_current(current), m_firstEnd(firstEnd), m_secondBegin(secondBegin)
+            {
+                SkipGap();
+            }
+
+            reference operator*() const
+            {
+                return *m_current;
+            }
+
+            pointer operator->() const
+            {
+                return m_current;
+            }
+
+            Iterator& operator++()
+            {
+                ++m_current;
+                SkipGap();
+                return *this;
+            }
+
+            Iterator operator++(int)
+            {
+                Iterator previous = *this;
+                ++*this;
+                return previous;
+            }
+
+            bool operator==(const Iterator& other) const
+            {
+                return m_current == other.m_current;
+            }
+
+          private:
+            const TEvent* m_current = nullptr;
+            const TEvent* m_firstEnd = nullptr;
+            const TEvent* m_secondBegin = nullptr;
+
+            void SkipGap()
+            {
+                if (m_current == m_firstEnd)
+                    m_current = m_secondBegin;
+            }
+        };
+
+        /**
+         * @brief Construct a new Event View object
+         *
+         * @param first the events that come first, the previous frame's
+         * @param second the events that come after, the current frame's
+         */
+        EventView(std::span<const TEvent> first, std::span<const TEvent> second) : m_first(first), m_second(second)
+        {
+        }
+
+        Iterator begin() const
+        {
+            return Iterator(m_first.data(), m_first.data() + m_first.size(), m_second.data());
+        }
+
+        Iterator end() const
+        {
+            const TEvent* secondEnd = m_second.data() + m_second.size();
+            return Iterator(secondEnd, secondEnd, secondEnd);
+        }
+
+        /**
+         * @brief Get the number of events
+         *
+         * @return size_t the number of events
+         */
+        size_t size() const
+        {
+            return m_first.size() + m_second.size();
+        }
+
+        /**
+         * @brief Check if there are no events
+         *
+         * @return true if there are no events
+         */
+        bool empty() const
+        {
+            return m_first.empty() && m_second.empty();
+        }
+
+        /**
+         * @brief Get an event by its position in the view
+         *
+         * @param index the position, it must be less than size()
+         * @return const TEvent& the event
+         */
+        const TEvent& operator[](size_t index) const
+        {
+            return index < m_first.size() ? m_first[index] : m_second[index - m_first.size()];
+        }
+
+        /**
+         * @brief Get the events that come first, for loops that want to work on contiguous memory
+         *
+         * @return std::span<const TEvent> the previous frame's events
+         */
+        std::span<const TEvent> GetFirst() const
+        {
+            return m_first;
+        }
+
+        /**
+         * @brief Get the events that come after the first
+         *
+         * @return std::span<const TEvent> the current frame's events
+         */
+        std::span<const TEvent> GetSecond() const
+        {
+            return m_second;
+        }
+
+      private:
+        std::span<const TEvent> m_first;
+        std::span<const TEvent> m_second;
+    };
+} // namespace Fenrir
@@ -1,11 +1,28 @@
 #include "FenrirApp/App.hpp"
 
+#include <algorithm>
+#include <chrono>
+
 namespace Fenrir
 {
+    namespace
+    {
+        // seconds spent in scenes this thread picked up while waiting inside another scene's systems, so the waiting
+        // scene can leave them out of its own stats
+        thread_local double t_nestedSceneTime = 0.0;
+
+        double SecondsSince(std::chrono::steady_clock::time_point start)
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+    } // namespace
+
     App::App(std::unique_ptr<ILogger> logger)
-        : m_time(), m_scheduler(), m_logger(std::move(logger)), m_scenes(), m_eventQueues()
+        : m_time(), m_scheduler(), m_logger(std::move(logger)), m_scenes(), m_sceneNames(), m_runningScenes(),
+          m_streams(), m_eventQueues(), m_ownedEventQueues(), m_eventQueueMutex()
     {
-        m_scenes.push_back(Scene("Default"));
+        CreateScene("Default");
+        ChangeActiveScene(m_sceneNames.at("Default"));
     }
 
     App& App::AddSystems(SchedulePriority priority, std::initializer_list<SystemFunc> systems)
@@ -25,6 +42,12 @@ namespace Fenrir
         return *this;
     }
 
+    App& App::AddSystem(SchedulePriority priority, SystemFunc system, SystemAccess access)
+    {
+        m_scheduler.AddSystem(priority, system, access);
+        return *this;
+    }
+
     const std::unique_ptr<ILogger>& App::Logger() const
     {
         return m_logger;
@@ -37,38 +60,206 @@ namespace Fenrir
 
     void App::UpdateEvents()
     {
-        for (auto& [type, queue] : m_eventQueues)
+        ++m_eventFrame;
+
+        // the events are merged once a frame, so the runs only have to be told apart within one
+        TaskOrder::SetRun(0);
+
+        // only queues that were sent to have anything to do, the rest age out on their own
+        std::lock_guard<std::mutex> lock(m_eventQueueMutex);
+        for (const auto& queue : m_ownedEventQueues)
         {
-            queue->Update();
+            if (queue->HasStaged())
+                queue->Merge(m_eventFrame);
         }
     }
 
+    void App::FlushCommands()
+    {
+        m_scenes.ForEach([](SceneHandle, Scene& scene) {
+            scene.GetEntityList().FlushCommands();
+
+            // the commands were stamped with this phase's tick, so the next phase starts on a new one
+            scene.GetEntityList().AdvanceChangeTick();
+        });
+    }
+
+    void App::UpdateWorldTransforms()
+    {
+        m_scenes.ForEach([](SceneHandle, Scene& scene) { scene.GetEntityList().UpdateWorldTransforms(); });
+    }
+
+    void App::CommitStreams()
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        for (size_t i = 0; i < m_streams.size();)
+        {
+            PendingStream& pending = m_streams[i];
+
+            Scene* scene = m_scenes.Get(pending.scene);
+            if (!scene)
+            {
+                m_logger->Error("A scene was destroyed while streaming into it");
+                m_streams.erase(m_streams.begin() + static_cast<int>(i));
+                continue;
+            }
+
+            const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            pending.stream->Commit(scene->GetEntityList(), std::max(m_streamingBudget - elapsed, 0.0));
+
+            if (!pending.stream->IsFinished())
+            {
+                ++i;
+                continue;
+            }
+
+            if (pending.stream->HasFailed())
+                m_logger->Error("Streaming into scene {0} failed, some entities were not loaded", scene->GetName());
+
+            m_streams.erase(m_streams.begin() + static_cast<int>(i));
+        }
+    }
+
+    void App::RunScenes(uint32_t ticks)
+    {
+        // every scene runs the same plan at once, so it has to be compiled before any of them start
+        if (!m_scheduler.IsFinalized())
+            m_scheduler.Finalize();
+
+        for (size_t i = 0; i < m_runningScenes.size();)
+        {
+            m_runningScenes[i].scene = m_scenes.Get(m_runningScenes[i].handle);
+            if (m_runningScenes[i].scene)
+                ++i;
+            else
+                m_runningScenes.erase(m_runningScenes.begin() + static_cast<int>(i));
+        }
+
+        // the scenes run the same systems with the same keys, so each one gets its own range of runs in scene order
+        const uint32_t firstRun = TaskOrder::GetRun();
+        const uint32_t runsPerScene = ticks + 1;
+
+        ThreadPool& threadPool = m_scheduler.GetThreadPool();
+        TaskCounter counter;
+        for (size_t i = 0; i < m_runningScenes.size(); ++i)
+        {
+            RunningScene& running = m_runningScenes[i];
+            const uint32_t run = firstRun + static_cast<uint32_t>(i) * runsPerScene;
+            threadPool.Dispatch([this, &running, ticks, run] { RunScene(running, ticks, run); }, counter);
+        }
+
+        threadPool.Wait(counter);
+
+        TaskOrder::SetRun(firstRun + static_cast<uint32_t>(m_runningScenes.size()) * runsPerScene);
+    }
+
+    uint32_t App::GetMaxTicks() const
+    {
+        // the Update and PostUpdate phases still take a run each after the ticks
+        constexpr uint32_t reserved = 2;
+        const uint32_t run = TaskOrder::GetRun();
+        if (run + reserved >= TaskOrder::MaxRuns)
+            return 0;
+
+        const uint32_t runsLeft = TaskOrder::MaxRuns - reserved - run;
+        if (m_runningScenes.empty())
+            return runsLeft - 1;
+
+        // each scene takes a run per tick and one for its update, which between them stand in for the Update phase
+        const uint32_t runsPerScene = runsLeft / static_cast<uint32_t>(m_runningScenes.size());
+        return runsPerScene > 0 ? runsPerScene - 1 : 0;
+    }
+
+    void App::RunScene(RunningScene& running, uint32_t ticks, uint32_t run)
+    {
+        // the scene is carried into any work the systems split off, so GetActiveScene returns it there too
+        TaskContext::Scope scope(running.scene);
+        TaskOrder::Scope orderScope(TaskOrder::ForRun(run));
+        EntityList& entityList = running.scene->GetEntityList();
+
+        // a wait inside this scene's systems may run another scene on this thread, whose time is taken back out
+        const double outerNestedTime = t_nestedSceneTime;
+        t_nestedSceneTime = 0.0;
+
+        const auto tickStart = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < ticks; ++i)
+        {
+            m_scheduler.RunSystemsInline(*this, SchedulePriority::Tick);
+            entityList.FlushCommands();
+            entityList.AdvanceChangeTick();
+        }
+        running.stats.tickTime = SecondsSince(tickStart) - t_nestedSceneTime;
+        t_nestedSceneTime = 0.0;
+
+        const auto updateStart = std::chrono::steady_clock::now();
+        entityList.UpdateWorldTransforms();
+        m_scheduler.RunSystemsInline(*this, SchedulePriority::Update);
+        entityList.FlushCommands();
+        entityList.AdvanceChangeTick();
+        running.stats.updateTime = SecondsSince(updateStart) - t_nestedSceneTime;
+
+        // if this scene was itself picked up inside another, all of its time is nested there
+        t_nestedSceneTime = outerNestedTime + SecondsSince(tickStart);
+
+        running.stats.ticks = ticks;
+        ++running.stats.frames;
+    }
+
     void App::Run()
     {
         m_scheduler.Init(*this);
+        m_scheduler.Finalize();
+        FlushCommands();
 
         while (m_running)
         {
             m_time.Update();
 
+            CommitStreams();
+
             m_scheduler.RunSystems(*this, SchedulePriority::PreUpdate);
+            FlushCommands();
+
+            // a frame with more ticks than the task order key has runs for leaves the rest for the next frame
+            const uint32_t maxTicks = GetMaxTicks();
 
-            while (m_time.accumulator >= m_time.tickRate)
+            if (m_runningScenes.empty())
             {
-                m_scheduler.RunSystems(*this, SchedulePriority::Tick);
+                for (uint32_t ticks = 0; ticks < maxTicks && m_time.accumulator >= m_time.tickRate; ++ticks)
+                {
+                    m_scheduler.RunSystems(*this, SchedulePriority::Tick);
+                    FlushCommands();
 
-                m_time.accumulator -= m_time.tickRate;
+                    m_time.accumulator -= m_time.tickRate;
+                }
+
+                UpdateWorldTransforms();
+
+                m_scheduler.RunSystems(*this, SchedulePriority::Update);
+                FlushCommands();
             }
+            else
+            {
+                uint32_t ticks = 0;
+                while (ticks < maxTicks && m_time.accumulator >= m_time.tickRate)
+                {
+                    ++ticks;
+                    m_time.accumulator -= m_time.tickRate;
+                }
 
-            m_scheduler.RunSystems(*this, SchedulePriority::Update);
+                RunScenes(ticks);
+            }
 
             m_scheduler.RunSystems(*this, SchedulePriority::PostUpdate);
+            FlushCommands();
 
             // m_scheduler.RunSystems(*this, SchedulePriority::LastUpdate);
 
             UpdateEvents();
         }
         m_scheduler.RunSystems(*this, SchedulePriority::Exit);
+        FlushCommands();
     }
 
     const Time& App::GetTime() const
@@ -78,60 +269,175 @@ namespace Fenrir
 
     Scene& App::GetActiveScene()
     {
-        return m_scenes.at(activeSceneIndex);
+        // the app is the only thing that sets a task context, and it always sets it to a running scene
+        Scene* runningScene = static_cast<Scene*>(TaskContext::Current());
+        return runningScene ? *runningScene : *m_activeScenePtr;
+    }
+
+    SceneHandle App::GetActiveSceneHandle() const
+    {
+        return m_activeScene;
     }
 
     void App::ChangeActiveScene(const std::string& name)
     {
+        const SceneHandle handle = FindScene(name);
+        if (!handle.IsSet())
+        {
+            //! if we get here, the scene doesnt exist
+            m_logger->Error("Scene with name {0} does not exist", name);
+            return;
+        }
+
+        ChangeActiveScene(handle);
+    }
 
-        for (size_t i = 0; i < m_scenes.size(); i++)
+    void App::ChangeActiveScene(SceneHandle handle)
+    {
+        Scene* scene = m_scenes.Get(handle);
+        if (!scene)
         {
-            if (m_scenes.at(i).GetName() == name)
-            {
-                activeSceneIndex = i;
-                return;
-            }
+            m_logger->Error("Can not change to a scene that has been destroyed");
+            return;
         }
 
-        //! if we get here, the scene doesnt exist
-        m_logger->Error("Scene with name {0} does not exist", name);
+        m_activeScene = handle;
+        m_activeScenePtr = scene;
     }
 
     Scene& App::CreateScene(const std::string& name)
     {
-        m_scenes.push_back(Scene(name));
-        return m_scenes.back();
+        auto it = m_sceneNames.find(name);
+        if (it != m_sceneNames.end())
+        {
+            m_logger->Error("Scene with name {0} already exists", name);
+            return *m_scenes.Get(it->second);
+        }
+
+        const SceneHandle handle = m_scenes.Add(Scene(name));
+        m_sceneNames.emplace(name, handle);
+
+        Scene& scene = *m_scenes.Get(handle);
+        scene.GetEntityList().SetThreadPool(&m_scheduler.GetThreadPool());
+        return scene;
     }
 
     void App::DestroyScene(const std::string& name)
     {
-        for (size_t i = 0; i < m_scenes.size(); i++)
+        const SceneHandle handle = FindScene(name);
+        if (!handle.IsSet())
         {
-            if (m_scenes.at(i).GetName() == name)
-            {
-                m_scenes.erase(m_scenes.begin() + static_cast<int>(i));
-                return;
-            }
+            //! if we get here, the scene doesnt exist
+            m_logger->Error("Scene with name {0} does not exist", name);
+            return;
         }
 
-        //! if we get here, the scene doesnt exist
-        m_logger->Error("Scene with name {0} does not exist", name);
+        DestroyScene(handle);
+    }
+
+    void App::DestroyScene(SceneHandle handle)
+    {
+        Scene* scene = m_scenes.Get(handle);
+        if (!scene)
+            return;
+
+        if (handle == m_activeScene)
+        {
+            m_logger->Error("Can not destroy the active scene {0}", scene->GetName());
+            return;
+        }
+
+        RemoveRunningScene(handle);
+        m_sceneNames.erase(scene->GetName());
+        m_scenes.Release(handle);
     }
 
     Scene& App::GetScene(const std::string& name)
     {
+        const SceneHandle handle = FindScene(name);
+        if (!handle.IsSet())
+        {
+            //! if we get here, the scene doesnt exist
+            m_logger->Error("Scene with name {0} does not exist", name);
+            return *m_activeScenePtr;
+        }
+
+        return *m_scenes.Get(handle);
+    }
+
+    Scene* App::GetScene(SceneHandle handle)
+    {
+        return m_scenes.Get(handle);
+    }
+
+    SceneHandle App::FindScene(const std::string& name) const
+    {
+        auto it = m_sceneNames.find(name);
+        return it != m_sceneNames.end() ? it->second : SceneHandle();
+    }
+
+    void App::RenameScene(SceneHandle handle, const std::string& name)
+    {
+        Scene* scene = m_scenes.Get(handle);
+        if (!scene || scene->GetName() == name)
+            return;
 
-        for (size_t i = 0; i < m_scenes.size(); i++)
+        if (m_sceneNames.contains(name))
         {
-            if (m_scenes.at(i).GetName() == name)
-            {
-                return m_scenes.at(i);
-            }
+            m_logger->Error("Scene with name {0} already exists", name);
+            return;
+        }
+
+        m_sceneNames.erase(scene->GetName());
+        m_sceneNames.emplace(name, handle);
+        scene->SetName(name);
+    }
+
+    std::shared_ptr<const SceneStream> App::StreamScene(SceneHandle scene, size_t count, size_t chunkSize,
+                                                        SceneChunkFunc build)
+    {
+        if (!m_scenes.IsValid(scene))
+        {
+            m_logger->Error("Can not stream into a scene that has been destroyed");
+            return nullptr;
         }
 
-        //! if we get here, the scene doesnt exist
-        m_logger->Error("Scene with name {0} does not exist", name);
-        return m_scenes.at(0);
+        auto stream = std::make_shared<SceneStream>(count, chunkSize, std::move(build));
+        stream->Start(m_scheduler.GetThreadPool());
+        m_streams.push_back({scene, stream});
+        return stream;
+    }
+
+    void App::AddRunningScene(SceneHandle handle)
+    {
+        Scene* scene = m_scenes.Get(handle);
+        if (!scene)
+        {
+            m_logger->Error("Can not run a scene that has been destroyed");
+            return;
+        }
+
+        auto it = std::find_if(m_runningScenes.begin(), m_runningScenes.end(),
+                               [&](const RunningScene& running) { return running.handle == handle; });
+        if (it == m_runningScenes.end())
+            m_runningScenes.push_back({handle, scene, SceneStats()});
+    }
+
+    void App::RemoveRunningScene(SceneHandle handle)
+    {
+        std::erase_if(m_runningScenes, [&](const RunningScene& running) { return running.handle == handle; });
+    }
+
+    const SceneStats* App::GetSceneStats(SceneHandle handle) const
+    {
+        auto it = std::find_if(m_runningScenes.begin(), m_runningScenes.end(),
+                               [&](const RunningScene& running) { return running.handle == handle; });
+        return it != m_runningScenes.end() ? &it->stats : nullptr;
+    }
+
+    void App::SetStreamingBudget(double budget)
+    {
+        m_streamingBudget = budget;
     }
 
 } // namespace Fenrir
\ No newline at end of file
@@ -0,0 +1,12 @@
+#include "FenrirApp/EventQueue.hpp"
+
+#include <atomic>
+
+namespace Fenrir
+{
+    uint32_t NextEventTypeId()
+    {
+        static std::atomic<uint32_t> next = 0;
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+} // namespace Fenrir
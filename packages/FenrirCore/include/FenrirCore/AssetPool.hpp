@@ -0,0 +1,211 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "Handle.hpp"
+
+namespace Fenrir
+{
+    /**
+     * @brief Reference counted storage for shared assets that are looked up through a Handle
+     * Each asset lives in its own allocation so references to it stay valid as the pool grows. An asset starts with a
+     * single reference held by whoever added it, and is destroyed once every reference has been released
+     *
+     * @tparam T the type of asset
+     */
+    template <typename T>
+    class AssetPool
+    {
+      public:
+        /**
+         * @brief Add an asset to the pool
+         *
+         * @param asset the asset to add
+         * @return Handle<T> the handle of the asset, which holds the first reference
+         */
+        Handle<T> Add(T asset);
+
+        /**
+         * @brief Get an asset from its handle
+         *
+         * @param handle the handle of the asset
+         * @return T* the asset, or nullptr if the handle is stale or was never set
+         */
+        T* Get(Handle<T> handle);
+
+        /**
+         * @brief Get an asset from its handle
+         *
+         * @param handle the handle of the asset
+         * @return const T* the asset, or nullptr if the handle is stale or was never set
+         */
+        const T* Get(Handle<T> handle) const;
+
+        /**
+         * @brief Check if a handle still points at an asset
+         *
+         * @param handle the handle to check
+         * @return true if the asset exists
+         */
+        bool IsValid(Handle<T> handle) const;
+
+        /**
+         * @brief Add a reference to an asset
+         *
+         * @param handle the handle of the asset
+         */
+        void Acquire(Handle<T> handle);
+
+        /**
+         * @brief Remove a reference from an asset, destroying it and freeing its slot once no references are left
+         *
+         * @param handle the handle of the asset
+         */
+        void Release(Handle<T> handle);
+
+        /**
+         * @brief Get the number of references to an asset
+         *
+         * @param handle the handle of the asset
+         * @return uint32_t the number of references, zero if the handle is stale
+         */
+        uint32_t GetRefCount(Handle<T> handle) const;
+
+        /**
+         * @brief Get the number of assets in the pool
+         *
+         * @return size_t the number of assets
+         */
+        size_t GetCount() const;
+
+        /**
+         * @brief Call a function on every asset in the pool, in slot order
+         *
+         * @tparam Func the function type
+         * @param func to call with the handle and the asset
+         */
+        template <typename Func>
+        void ForEach(Func&& func);
+
+      private:
+        struct Slot
+        {
+            std::unique_ptr<T> asset;
+            uint32_t generation = 0;
+            uint32_t refCount = 0;
+        };
+
+        std::vector<Slot> m_slots;
+        std::vector<uint32_t> m_freeSlots;
+        size_t m_count = 0;
+
+        const Slot* Find(Handle<T> handle) const;
+    };
+
+    template <typename T>
+    Handle<T> AssetPool<T>::Add(T asset)
+    {
+        uint32_t index;
+        if (!m_freeSlots.empty())
+        {
+            index = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        }
+        else
+        {
+            index = static_cast<uint32_t>(m_slots.size());
+            m_slots.emplace_back();
+        }
+
+        Slot& slot = m_slots[index];
+        slot.asset = std::make_unique<T>(std::move(asset));
+        slot.refCount = 1;
+        ++m_count;
+
+        return Handle<T>{index, slot.generation};
+    }
+
+    template <typename T>
+    T* AssetPool<T>::Get(Handle<T> handle)
+    {
+        const Slot* slot = Find(handle);
+        return slot ? slot->asset.get() : nullptr;
+    }
+
+    template <typename T>
+    const T* AssetPool<T>::Get(Handle<T> handle) const
+    {
+        const Slot* slot = Find(handle);
+        return slot ? slot->asset.get() : nullptr;
+    }
+
+    template <typename T>
+    bool AssetPool<T>::IsValid(Handle<T> handle) const
+    {
+        return Find(handle) != nullptr;
+    }
+
+    template <typename T>
+    void AssetPool<T>::Acquire(Handle<T> handle)
+    {
+        if (Find(handle))
+            ++m_slots[handle.index].refCount;
+    }
+
+    template <typename T>
+    void AssetPool<T>::Release(Handle<T> handle)
+    {
+        if (!Find(handle))
+            return;
+
+        Slot& slot = m_slots[handle.index];
+        if (--slot.refCount > 0)
+            return;
+
+        slot.asset.reset();
+        ++slot.generation;
+        m_freeSlots.push_back(handle.index);
+        --m_count;
+    }
+
+    template <typename T>
+    uint32_t AssetPool<T>::GetRefCount(Handle<T> handle) const
+    {
+        const Slot* slot = Find(handle);
+        return slot ? slot->refCount : 0;
+    }
+
+    template <typename T>
+    size_t AssetPool<T>::GetCount() const
+    {
+        return m_count;
+    }
+
+    template <typename T>
+    template <typename Func>
+    void AssetPool<T>::ForEach(Func&& func)
+    {
+        for (size_t i = 0; i < m_slots.size(); ++i)
+        {
+            Slot& slot = m_slots[i];
+            if (slot.asset)
+                func(Handle<T>{static_cast<uint32_t>(i), slot.generation}, *slot.asset);
+        }
+    }
+
+    template <typename T>
+    const typename AssetPool<T>::Slot* AssetPool<T>::Find(Handle<T> handle) const
+    {
+        if (handle.index >= m_slots.size())
+            return nullptr;
+
+        const Slot& slot = m_slots[handle.index];
+        if (slot.generation != handle.generation || !slot.asset)
+            return nullptr;
+
+        return &slot;
+    }
+} // namespace Fenrir
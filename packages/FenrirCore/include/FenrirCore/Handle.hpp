@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Fenrir
+{
+    /**
+     * @brief A generational index into an AssetPool, it is 8 bytes so it can be stored on every entity instead of a
+     * copy of the asset. The generation goes up every time a slot is reused, so a handle to an asset that has been
+     * released no longer resolves rather than pointing at whatever took its place
+     *
+     * @tparam T the type of asset the handle points to
+     */
+    template <typename T>
+    struct Handle
+    {
+        static constexpr uint32_t InvalidIndex = 0xFFFFFFFF;
+
+        uint32_t index = InvalidIndex;
+        uint32_t generation = 0;
+
+        /**
+         * @brief Check if the handle was ever given an asset, use AssetPool::IsValid to check if the asset still
+         * exists
+         *
+         * @return true if the handle points at a slot
+         */
+        bool IsSet() const
+        {
+            return index != InvalidIndex;
+        }
+
+        bool operator==(const Handle& other) const = default;
+    };
+} // namespace Fenrir
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Fenrir
+{
+    /**
+     * @brief A deduplicated table of strings that hands out a small id for each one
+     * Interning the same string twice returns the same id, so ids can be compared instead of strings. Strings are
+     * never removed or moved, so looking a string up by id is two array indexes and does not take a lock. Interning is
+     * safe to call from multiple threads at once
+     *
+     */
+    class StringPool
+    {
+      public:
+        /**
+         * @brief the id of the empty string, which every pool starts with
+         *
+         */
+        static constexpr uint32_t EmptyId = 0;
+
+        /**
+         * @brief the id returned when a string has not been interned
+         *
+         */
+        static constexpr uint32_t InvalidId = 0xFFFFFFFF;
+
+        /**
+         * @brief Construct a new String Pool object
+         *
+         */
+        StringPool();
+
+        StringPool(const StringPool&) = delete;
+
+        StringPool& operator=(const StringPool&) = delete;
+
+        /**
+         * @brief Get the pool shared by the whole engine
+         *
+         * @return StringPool& the global pool
+         */
+        static StringPool& Global();
+
+        /**
+         * @brief Get the id of a string, adding it to the pool if it is not already in it
+         *
+         * @param str the string to intern
+         * @return uint32_t the id of the string
+         */
+        uint32_t Intern(std::string_view str);
+
+        /**
+         * @brief Get the id of a string without adding it to the pool
+         *
+         * @param str the string to find
+         * @return uint32_t the id of the string, or InvalidId if it has not been interned
+         */
+        uint32_t Find(std::string_view str) const;
+
+        /**
+         * @brief Get the string of an id
+         *
+         * @param id the id of the string
+         * @return std::string_view the string, which is null terminated and lives as long as the pool, or an empty
+         * string if the id is not in the pool
+         */
+        std::string_view Get(uint32_t id) const;
+
+        /**
+         * @brief Get the number of unique strings in the pool
+         *
+         * @return size_t the number of strings
+         */
+        size_t GetCount() const;
+
+      private:
+        static constexpr uint32_t PageShift = 12;
+        static constexpr uint32_t PageSize = 1u << PageShift;
+        static constexpr uint32_t MaxPages = 4096;
+        static constexpr size_t CharBlockSize = 64 * 1024;
+
+        // pages of string views are allocated as needed and never move, so readers can index them without a lock
+        std::array<std::unique_ptr<std::string_view[]>, MaxPages> m_pages;
+
+        // the characters of every string, blocks are never reallocated so the views stay valid
+        std::vector<std::unique_ptr<char[]>> m_charBlocks;
+        size_t m_charOffset;
+        size_t m_charCapacity;
+
+        std::unordered_map<std::string_view, uint32_t> m_index;
+
+        // ids below the count are fully written, it is published last so Get never sees a partial entry
+        std::atomic<uint32_t> m_count;
+
+        mutable std::shared_mutex m_mutex;
+
+        /**
+         * @brief Copy a string into the character blocks, must be called with the lock held
+         *
+         * @param str the string to copy
+         * @return std::string_view the stored copy
+         */
+        std::string_view Store(std::string_view str);
+    };
+} // namespace Fenrir
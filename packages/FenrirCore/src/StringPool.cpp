@@ -0,0 +1,91 @@
+#include "FenrirCore/StringPool.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+
+namespace Fenrir
+{
+    StringPool::StringPool() : m_pages(), m_charBlocks(), m_charOffset(0), m_charCapacity(0), m_index(), m_count(0)
+    {
+        Intern(std::string_view());
+    }
+
+    StringPool& StringPool::Global()
+    {
+        static StringPool pool;
+        return pool;
+    }
+
+    uint32_t StringPool::Intern(std::string_view str)
+    {
+        {
+            std::shared_lock<std::shared_mutex> lock(m_mutex);
+            auto it = m_index.find(str);
+            if (it != m_index.end())
+                return it->second;
+        }
+
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+        // another thread may have interned it between the two locks
+        auto it = m_index.find(str);
+        if (it != m_index.end())
+            return it->second;
+
+        const uint32_t id = m_count.load(std::memory_order_relaxed);
+        const uint32_t page = id >> PageShift;
+        if (page >= MaxPages)
+            throw std::runtime_error("StringPool is full");
+
+        if (!m_pages[page])
+            m_pages[page] = std::make_unique<std::string_view[]>(PageSize);
+
+        const std::string_view stored = Store(str);
+        m_pages[page][id & (PageSize - 1)] = stored;
+        m_index.emplace(stored, id);
+
+        m_count.store(id + 1, std::memory_order_release);
+        return id;
+    }
+
+    uint32_t StringPool::Find(std::string_view str) const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        auto it = m_index.find(str);
+        return it != m_index.end() ? it->second : InvalidId;
+    }
+
+    std::string_view StringPool::Get(uint32_t id) const
+    {
+        if (id >= m_count.load(std::memory_order_acquire))
+            return std::string_view();
+
+        return m_pages[id >> PageShift][id & (PageSize - 1)];
+    }
+
+    size_t StringPool::GetCount() const
+    {
+        return m_count.load(std::memory_order_acquire);
+    }
+
+    std::string_view StringPool::Store(std::string_view str)
+    {
+        const size_t size = str.size() + 1;
+        if (m_charOffset + size > m_charCapacity)
+        {
+            m_charCapacity = std::max(CharBlockSize, size);
+            m_charBlocks.push_back(std::make_unique<char[]>(m_charCapacity));
+            m_charOffset = 0;
+        }
+
+        char* data = m_charBlocks.back().get() + m_charOffset;
+        if (!str.empty())
+            std::memcpy(data, str.data(), str.size());
+        data[str.size()] = '\0';
+        m_charOffset += size;
+
+        return std::string_view(data, str.size());
+    }
+} // namespace Fenrir
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <entt/entity/registry.hpp>
+
+#include <cstdint>
+#include <type_traits>
+
+namespace Fenrir
+{
+    /**
+     * @brief The ticks at which a tracked component was added to an entity and last changed, kept up to date by the
+     * entity list for every type passed to EntityList::TrackChanges
+     *
+     * @tparam T the type of component the ticks belong to
+     */
+    template <typename T>
+    struct ComponentTicks
+    {
+        uint32_t added = 0;
+        uint32_t changed = 0;
+    };
+
+    /**
+     * @brief A query filter that matches entities whose T was added or changed after a tick, the tick should come
+     * from EntityList::ClaimChangeTick at the end of the system's previous run
+     *
+     * @tparam T the tracked component type
+     */
+    template <typename T>
+    struct Changed
+    {
+        using Component = T;
+
+        uint32_t sinceTick = 0;
+
+        bool Matches(const ComponentTicks<T>& ticks) const
+        {
+            return ticks.changed > sinceTick;
+        }
+    };
+
+    /**
+     * @brief A query filter that matches entities whose T was added after a tick, the tick should come from
+     * EntityList::ClaimChangeTick at the end of the system's previous run
+     *
+     * @tparam T the tracked component type
+     */
+    template <typename T>
+    struct Added
+    {
+        using Component = T;
+
+        uint32_t sinceTick = 0;
+
+        bool Matches(const ComponentTicks<T>& ticks) const
+        {
+            return ticks.added > sinceTick;
+        }
+    };
+
+    /**
+     * @brief A view of entities with the given components that only yields entities matching a Changed or Added filter
+     *
+     * @tparam View the underlying view, which includes the ticks of the filtered component
+     * @tparam Filter the filter
+     * @tparam Components the components passed to each
+     */
+    template <typename View, typename Filter, typename... Components>
+    class FilteredView
+    {
+      public:
+        /**
+         * @brief Construct a new Filtered View object
+         *
+         * @param view the underlying view
+         * @param filter the filter to apply
+         */
+        FilteredView(View view, Filter filter) : m_view(view), m_filter(filter)
+        {
+        }
+
+        /**
+         * @brief Call a function on each matching entity, with the entity first if the function takes it. Components
+         * must not be empty types
+         *
+         * @tparam Func the function type
+         * @param func to call on each entity
+         */
+        template <typename Func>
+        void each(Func&& func)
+        {
+            for (const entt::entity entity : m_view)
+            {
+                if (!m_filter.Matches(m_view.template get<TicksType>(entity)))
+                    continue;
+
+                if constexpr (std::is_invocable_v<Func, entt::entity, Components&...>)
+                    func(entity, m_view.template get<Components>(entity)...);
+                else
+                    func(m_view.template get<Components>(entity)...);
+            }
+        }
+
+        /**
+         * @brief Check if an entity is in the view and matches the filter
+         *
+         * @param entity the entity to check
+         * @return true if it matches
+         */
+        bool contains(entt::entity entity) const
+        {
+            return m_view.contains(entity) && m_filter.Matches(m_view.template get<TicksType>(entity));
+        }
+
+        /**
+         * @brief Get a component of an entity in the view
+         *
+         * @tparam T the type of component
+         * @param entity the entity
+         * @return T& the component
+         */
+        template <typename T>
+        T& get(entt::entity entity) const
+        {
+            return m_view.template get<T>(entity);
+        }
+
+      private:
+        using TicksType = ComponentTicks<typename Filter::Component>;
+
+        View m_view;
+        Filter m_filter;
+    };
+} // namespace Fenrir
@@ -0,0 +1,275 @@
+#pragma once
+
+#include <entt/entity/registry.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Fenrir
+{
+    /**
+     * @brief An entity that has been recorded in a command buffer but not created yet, it can only be used with the
+     * command buffer that created it. Command buffers belong to threads, so a deferred entity must not be handed to
+     * work that may run on another thread such as a ParallelForEach chunk
+     *
+     */
+    struct DeferredEntity
+    {
+        uint32_t index = 0;
+        uint32_t buffer = 0; // the id of the command buffer that created the entity, zero is never a buffer
+    };
+
+    /**
+     * @brief Records structural changes to an entity list so they can be made later from a single thread
+     * Each thread running scheduled work records into its own buffer from EntityList::GetCommandBuffer, so recording
+     * never takes a lock. EntityList::FlushCommands then plays every buffer back in the order of the work that recorded
+     * them, which is the same every run regardless of which thread did the work
+     *
+     */
+    class CommandBuffer
+    {
+      public:
+        /**
+         * @brief Construct a new Command Buffer object with an id no other buffer has
+         *
+         */
+        CommandBuffer();
+
+        /**
+         * @brief Destroy the Command Buffer object along with any commands that were never played back
+         *
+         */
+        ~CommandBuffer();
+
+        CommandBuffer(const CommandBuffer&) = delete;
+
+        CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+        /**
+         * @brief Record the creation of an entity, it will have the same default components as
+         * EntityList::CreateEntity
+         *
+         * @return DeferredEntity the entity that will be created, used to add components to it before it exists
+         */
+        DeferredEntity CreateEntity();
+
+        /**
+         * @brief Record the destruction of an entity, ignored if the entity no longer exists when played back
+         *
+         * @param id The id of the entity to destroy
+         */
+        void DestroyEntity(uint32_t id);
+
+        /**
+         * @brief Record the destruction of an entity created by this buffer
+         *
+         * @param entity The entity to destroy
+         * @throws std::invalid_argument if the entity was created by another buffer
+         */
+        void DestroyEntity(DeferredEntity entity);
+
+        /**
+         * @brief Record adding a component to an entity. The component is built now and moved into the entity when
+         * played back, replacing it if the entity already has one
+         *
+         * @tparam T The type of component to add
+         * @tparam Args The arguments to pass to the constructor of the component
+         * @param id The id of the entity
+         * @param args The arguments to pass to the constructor of the component
+         */
+        template <typename T, typename... Args>
+        void AddComponent(uint32_t id, Args&&... args);
+
+        /**
+         * @brief Record adding a component to an entity created by this buffer
+         *
+         * @tparam T The type of component to add
+         * @tparam Args The arguments to pass to the constructor of the component
+         * @param entity The entity
+         * @param args The arguments to pass to the constructor of the component
+         * @throws std::invalid_argument if the entity was created by another buffer
+         */
+        template <typename T, typename... Args>
+        void AddComponent(DeferredEntity entity, Args&&... args);
+
+        /**
+         * @brief Record removing a component from an entity, ignored if the entity does not have it
+         *
+         * @tparam T The type of component to remove
+         * @param id The id of the entity
+         */
+        template <typename T>
+        void RemoveComponent(uint32_t id);
+
+        /**
+         * @brief Record removing a component from an entity created by this buffer
+         *
+         * @tparam T The type of component to remove
+         * @param entity The entity
+         * @throws std::invalid_argument if the entity was created by another buffer
+         */
+        template <typename T>
+        void RemoveComponent(DeferredEntity entity);
+
+        /**
+         * @brief Check if the buffer has no recorded commands
+         *
+         * @return true if there are no commands
+         */
+        bool IsEmpty() const;
+
+        /**
+         * @brief Get the number of recorded commands
+         *
+         * @return size_t the number of commands
+         */
+        size_t GetCommandCount() const;
+
+        /**
+         * @brief Throw away every recorded command, the memory is kept so the next frame can record without allocating
+         *
+         */
+        void Clear();
+
+      private:
+        using ApplyFunc = void (*)(entt::registry&, entt::entity, void*);
+        using DestroyFunc = void (*)(void*);
+
+        enum class CommandType : uint8_t
+        {
+            Create,
+            Destroy,
+            Component
+        };
+
+        /**
+         * @brief a single recorded command, components are stored in the arena and applied through a function pointer
+         * so the buffer does not need to know every component type
+         *
+         */
+        struct Command
+        {
+            uint64_t order;    // the TaskOrder key of the work that recorded the command
+            uint32_t sequence; // the position of the command in this buffer
+            uint32_t target;   // an entity id, or the index of a deferred entity
+            CommandType type;
+            bool deferred;
+            void* payload;
+            ApplyFunc apply;
+            DestroyFunc destroy;
+        };
+
+        /**
+         * @brief a chunk of memory that component payloads are placed in
+         *
+         */
+        struct Block
+        {
+            std::unique_ptr<std::byte[]> data;
+            size_t size = 0;
+        };
+
+        static constexpr size_t BlockSize = 16 * 1024;
+
+        uint32_t m_id;
+        std::vector<Command> m_commands;
+        std::vector<Block> m_blocks;
+        size_t m_blockIndex = 0;
+        size_t m_blockOffset = 0;
+        uint32_t m_deferredCount = 0;
+
+        // the real entity of each deferred entity, filled in while the buffer is played back
+        std::vector<entt::entity> m_created;
+
+        /**
+         * @brief Record a command with the calling thread's order key
+         *
+         * @param type the type of command
+         * @param target the entity id, or the deferred entity index
+         * @param deferred if the target is a deferred entity
+         * @param payload the component to add, if any
+         * @param apply the function that applies a component command
+         * @param destroy the function that destroys the payload
+         */
+        void Record(CommandType type, uint32_t target, bool deferred, void* payload = nullptr,
+                    ApplyFunc apply = nullptr, DestroyFunc destroy = nullptr);
+
+        /**
+         * @brief Make sure a deferred entity was created by this buffer, its index means nothing to any other buffer
+         *
+         * @param entity the entity
+         */
+        void CheckOwner(DeferredEntity entity) const;
+
+        /**
+         * @brief Get aligned memory from the arena, a new block is only allocated when the current ones are used up
+         *
+         * @param size the size of the memory
+         * @param alignment the alignment of the memory
+         * @return void* the memory
+         */
+        void* Allocate(size_t size, size_t alignment);
+
+        template <typename T, typename... Args>
+        void RecordAdd(uint32_t target, bool deferred, Args&&... args);
+
+        template <typename T>
+        void RecordRemove(uint32_t target, bool deferred);
+
+        friend class EntityList;
+    };
+
+    template <typename T, typename... Args>
+    void CommandBuffer::AddComponent(uint32_t id, Args&&... args)
+    {
+        RecordAdd<T>(id, false, std::forward<Args>(args)...);
+    }
+
+    template <typename T, typename... Args>
+    void CommandBuffer::AddComponent(DeferredEntity entity, Args&&... args)
+    {
+        CheckOwner(entity);
+        RecordAdd<T>(entity.index, true, std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    void CommandBuffer::RemoveComponent(uint32_t id)
+    {
+        RecordRemove<T>(id, false);
+    }
+
+    template <typename T>
+    void CommandBuffer::RemoveComponent(DeferredEntity entity)
+    {
+        CheckOwner(entity);
+        RecordRemove<T>(entity.index, true);
+    }
+
+    template <typename T, typename... Args>
+    void CommandBuffer::RecordAdd(uint32_t target, bool deferred, Args&&... args)
+    {
+        static_assert(std::is_move_constructible_v<T>, "deferred components must be move constructible");
+
+        void* payload = new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+
+        ApplyFunc apply = [](entt::registry& registry, entt::entity entity, void* data) {
+            registry.emplace_or_replace<T>(entity, std::move(*static_cast<T*>(data)));
+        };
+        DestroyFunc destroy = [](void* data) { static_cast<T*>(data)->~T(); };
+
+        Record(CommandType::Component, target, deferred, payload, apply, destroy);
+    }
+
+    template <typename T>
+    void CommandBuffer::RecordRemove(uint32_t target, bool deferred)
+    {
+        ApplyFunc apply = [](entt::registry& registry, entt::entity entity, void*) { registry.remove<T>(entity); };
+
+        Record(CommandType::Component, target, deferred, nullptr, apply);
+    }
+} // namespace Fenrir
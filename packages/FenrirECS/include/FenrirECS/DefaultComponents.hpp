@@ -1,5 +1,9 @@
 #pragma once
 
+#include <cstdint>
+#include <string_view>
+
+#include "FenrirCore/StringPool.hpp"
 #include "FenrirMath/Math.hpp"
 
 namespace Fenrir
@@ -18,10 +22,61 @@ namespace Fenrir
         Fenrir::Math::Vec3 scale = Fenrir::Math::Vec3(1.0f, 1.0f, 1.0f);
     };
 
+    /**
+     * @brief The name of an entity, stored as a handle into the global StringPool so every entity only pays for four
+     * bytes and entities with the same name share one copy of it
+     *
+     */
     struct Name
     {
-        // max name length is 255 characters
-        char name[256] = {0};
+        Name() = default;
+
+        Name(std::string_view name) : id(StringPool::Global().Intern(name))
+        {
+        }
+
+        /**
+         * @brief Get the name as a string
+         *
+         * @return std::string_view the name, empty if it was never set
+         */
+        std::string_view Get() const
+        {
+            return StringPool::Global().Get(id);
+        }
+
+        uint32_t id = StringPool::EmptyId;
+    };
+
+    /**
+     * @brief The place of an entity in the transform hierarchy. Entities with a Hierarchy, Transform and
+     * WorldTransform have their world matrix kept up to date by EntityList::UpdateWorldTransforms, use
+     * EntityList::SetParent to change the parent so the hierarchy is rebuilt
+     *
+     */
+    struct Hierarchy
+    {
+        static constexpr uint32_t NullParent = 0xFFFFFFFF;
+
+        uint32_t parent = NullParent;
+
+        // the number of ancestors, filled in by the entity list when the hierarchy changes
+        uint32_t depth = 0;
+
+        // the last update pass that recomputed the world matrix, used to push changes down to children
+        uint32_t updatedPass = 0;
+
+        // set when the local Transform changes so the entity and its children are recomputed on the next update
+        bool dirty = true;
+    };
+
+    /**
+     * @brief The cached world matrix of an entity in the transform hierarchy
+     *
+     */
+    struct WorldTransform
+    {
+        Fenrir::Math::Mat4 matrix = Fenrir::Math::Mat4(1.0f);
     };
 
 } // namespace Fenrir
\ No newline at end of file
@@ -23,14 +23,19 @@ namespace Fenrir
 
         /**
          * @brief Construct a new Entity object
+         * This is only a handle to an existing entity, it does not touch any component storage. Use
+         * EntityList::CreateEntity to create an entity with its default components
          *
          * @param id The id of the entity
          * @param entityList The entity list that the entity belongs to
          */
-        Entity(uint32_t id, EntityList* entityList);
+        Entity(uint32_t id, EntityList* entityList)
+            : m_entityId(static_cast<entt::entity>(id)), m_entityList(entityList)
+        {
+        }
 
         /**
-         * @brief Add a component to the entity. If the component already exists it wont add it
+         * @brief Add a component to the entity. If the component already exists it is replaced in place
          *
          * @tparam T The type of component to add
          * @tparam Args The arguments to pass to the constructor of the component
@@ -103,15 +108,8 @@ namespace Fenrir
     template <typename T, typename... Args>
     T& Entity::AddComponent(Args&&... args)
     {
-        if (HasComponent<T>())
-        {
-            //!! for now lets override but this might be bad??
-            RemoveComponent<T>();
-
-            // return GetComponent<T>();
-        }
-
-        return m_entityList->m_registry.emplace<T>(m_entityId, std::forward<Args>(args)...);
+        // replacing in place keeps the component's slot in storage rather than removing and re-adding it
+        return m_entityList->m_registry.emplace_or_replace<T>(m_entityId, std::forward<Args>(args)...);
     }
 
     template <typename T>
@@ -2,8 +2,28 @@
 
 #include <entt/entity/registry.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
 #include <vector>
 
+#include "FenrirScheduler/TaskContext.hpp"
+#include "FenrirScheduler/TaskOrder.hpp"
+#include "FenrirScheduler/ThreadPool.hpp"
+
+#include "ChangeDetection.hpp"
+#include "CommandBuffer.hpp"
+#include "DefaultComponents.hpp"
+#include "LocalitySort.hpp"
+#include "Observer.hpp"
+#include "PageTracker.hpp"
+
 namespace Fenrir
 {
     class Entity;
@@ -19,15 +39,28 @@ namespace Fenrir
          * @brief Construct a new Entity List object
          *
          */
-        EntityList() = default;
+        EntityList();
 
         /**
-         * @brief Create a Entity object
+         * @brief Create a Entity object with a default Transform and Name
          *
          * @return Entity that was created
          */
         Entity CreateEntity();
 
+        /**
+         * @brief Create many entities at once, each storage is filled in a single pass rather than one entity at a time
+         * Every entity gets a copy of each prototype, along with a default Transform and Name unless a prototype of
+         * that type is given
+         *
+         * @tparam Prototypes The types of the prototype components
+         * @param count The number of entities to create
+         * @param prototypes The components to copy onto every entity
+         * @return std::vector<uint32_t> The ids of the entities that were created
+         */
+        template <typename... Prototypes>
+        std::vector<uint32_t> CreateEntities(size_t count, const Prototypes&... prototypes);
+
         /**
          * @brief Get the Entity object
          *
@@ -50,6 +83,23 @@ namespace Fenrir
          */
         void DestroyEntity(Entity entity);
 
+        /**
+         * @brief Destroy every entity in a range of ids at once, ids that do not exist or are repeated are ignored
+         *
+         * @tparam It The iterator type of the range, it must dereference to a uint32_t id
+         * @param first The start of the range
+         * @param last The end of the range
+         */
+        template <typename It>
+        void DestroyEntities(It first, It last);
+
+        /**
+         * @brief Destroy every entity in a list of ids at once
+         *
+         * @param ids The ids of the entities to destroy
+         */
+        void DestroyEntities(const std::vector<uint32_t>& ids);
+
         /**
          * @brief Check if the entity list has an entity with the given id
          *
@@ -59,6 +109,150 @@ namespace Fenrir
          */
         bool HasEntity(uint32_t id);
 
+        /**
+         * @brief Set the name of an entity, adding a Name component if it does not have one
+         *
+         * @param id The id of the entity
+         * @param name The name to give it
+         */
+        void SetName(uint32_t id, std::string_view name);
+
+        /**
+         * @brief Find an entity by its name using the name index, names should be changed with SetName or by adding
+         * a Name component so the index sees the change. Entities with the default empty name are not indexed
+         *
+         * @param name The name to search for
+         * @return Entity the first entity with the name, or an invalid entity if no entity has it
+         */
+        Entity FindEntityByName(std::string_view name);
+
+        /**
+         * @brief Set the parent of an entity in the transform hierarchy, both entities are added to the hierarchy with
+         * a Hierarchy and WorldTransform component if they are not in it yet
+         *
+         * @param child The id of the child entity
+         * @param parent The id of the parent entity
+         * @return true if the parent was set
+         * @return false if either entity does not exist or the parent is a descendant of the child
+         */
+        bool SetParent(uint32_t child, uint32_t parent);
+
+        /**
+         * @brief Make an entity a root of the transform hierarchy, adding it to the hierarchy if it is not in it yet
+         *
+         * @param child The id of the entity
+         */
+        void ClearParent(uint32_t child);
+
+        /**
+         * @brief Mark the local Transform of an entity as changed so its world matrix and those of its children are
+         * recomputed on the next update. This only writes to the entity's own Hierarchy, so it is safe to call from
+         * parallel loops that give each entity to a single thread. Replacing a Transform with AddComponent marks it
+         * automatically. The update that recomputes it also marks the Transform as changed for the Changed filter
+         *
+         * @param id The id of the entity
+         */
+        void MarkTransformDirty(uint32_t id);
+
+        /**
+         * @brief Recompute the world matrix of every entity whose Transform, or the Transform of one of its
+         * ancestors, has changed since the last update. Entities are processed one depth at a time so every parent is
+         * finished before its children, and each depth is split across the thread pool. The depth order is only
+         * rebuilt after the hierarchy changes
+         *
+         */
+        void UpdateWorldTransforms();
+
+        /**
+         * @brief Start recording when components of a type are added or changed so they can be queried with the
+         * Changed and Added filters. Components added or replaced through the registry, the command buffers or
+         * MarkComponentChanged are recorded, components that already exist are stamped with the current tick
+         *
+         * @tparam T The type of component to track
+         */
+        template <typename T>
+        void TrackChanges();
+
+        /**
+         * @brief Mark a component as changed at the current tick, this is needed after changing a component in place
+         * through a reference. It only writes to the entity's own ticks and marks the component's page for the next
+         * fork, so it is safe to call from parallel loops that give each entity to a single thread
+         *
+         * @tparam T The type of component that changed, it must be tracked for the Changed filter to see it
+         * @param id The id of the entity
+         */
+        template <typename T>
+        void MarkComponentChanged(uint32_t id);
+
+        /**
+         * @brief Get the current change tick, which is the tick added and changed components are stamped with
+         *
+         * @return uint32_t the current tick
+         */
+        uint32_t GetChangeTick() const;
+
+        /**
+         * @brief Get the tick a system should pass to a filter the next time it runs, and move on to a new tick so any
+         * change made after this call is newer. Call it once the system has finished its own writes, so the next run
+         * sees every change made by others since and none of the changes it made itself. Filters start from zero, so
+         * the first run sees everything
+         *
+         * @return uint32_t the tick to pass to the filter on the next run
+         */
+        uint32_t ClaimChangeTick();
+
+        /**
+         * @brief Move on to the next change tick, the app calls this after each phase
+         *
+         */
+        void AdvanceChangeTick();
+
+        /**
+         * @brief Register a sort that keeps related pools in a common order, so views over them walk memory linearly.
+         * The lead pool is sorted with compare and every follower pool is arranged to match it. The sort only runs
+         * from RunLocalityMaintenance, a slice at a time, and only after the pools have changed. Types owned by a
+         * group must not be used, as groups keep their own order
+         *
+         * @tparam Lead The component type whose pool decides the order
+         * @tparam Followers The component types whose pools follow the lead
+         * @tparam Compare The compare function type, taking two Lead components or two entities
+         * @param compare The compare function
+         */
+        template <typename Lead, typename... Followers, typename Compare>
+        void AddLocalitySort(Compare compare);
+
+        /**
+         * @brief Run the registered locality sorts whose pools have changed until the time budget is used up. Sorts
+         * are incremental, each call runs small slices of them and the next call carries on where this one stopped, so
+         * a large pool is sorted over several frames rather than blowing the budget of one. Pools that have barely
+         * changed are insertion sorted, which is close to linear on nearly sorted data, and anything else is heap
+         * sorted. This must not be called while systems are iterating the pools
+         *
+         * @param budget The time budget in seconds, the time is checked between slices so at most one slice runs past
+         * it
+         * @return size_t The number of sorts that finished, leaving their pools in order
+         */
+        size_t RunLocalityMaintenance(double budget);
+
+        /**
+         * @brief Create an observer that records the entities that see any of the given events, so a system can do
+         * work for just those entities rather than scanning them all every frame. The entity list owns the observer,
+         * it lives until DestroyObserver is called or the entity list is destroyed
+         *
+         * @tparam Events the events to record, any mix of OnAdded, OnRemoved and OnUpdated of component types, at most
+         * Observer::MaxEvents
+         * @return Observer& the observer
+         */
+        template <typename... Events>
+        Observer& CreateObserver();
+
+        /**
+         * @brief Disconnect and destroy an observer made by CreateObserver
+         *
+         * @param observer the observer, it must not be used afterwards
+         */
+        void DestroyObserver(Observer& observer);
+
         /**
          * @brief Clear the entity list
          *
@@ -75,6 +269,34 @@ namespace Fenrir
         template <typename... Components, typename Func>
         void ForEach(Func&& func);
 
+        /**
+         * @brief ForEach loop for all entities with the given components that match a Changed or Added filter, the
+         * filtered type must be tracked with TrackChanges. The filter is checked on every entity of the view, so this
+         * is O(N) in the size of the view. Use an observer to visit only the entities that changed
+         *
+         * @tparam Components to loop over, they must not be empty types
+         * @tparam Filter the Changed or Added filter type
+         * @tparam Func to call on each entity
+         * @param filter the filter, for example Changed<Transform>{lastTick} where lastTick came from ClaimChangeTick
+         * @param func to call on each entity
+         */
+        template <typename... Components, typename Filter, typename Func>
+        void ForEach(Filter filter, Func&& func);
+
+        /**
+         * @brief Parallel ForEach loop for all entities with the given components
+         * The entities are split into chunks of grainSize which are run on the thread pool, so func must be safe to
+         * call from multiple threads at once and must not create or destroy entities or components. Components must
+         * not be empty types. Runs on the calling thread when no thread pool is set
+         *
+         * @tparam Components to loop over, the storage of the first component decides how entities are chunked
+         * @tparam Func to call on each entity with a reference to each component
+         * @param func to call on each entity
+         * @param grainSize the number of entities in each chunk
+         */
+        template <typename... Components, typename Func>
+        void ParallelForEach(Func&& func, size_t grainSize = 1024);
+
         /**
          * @brief Group ForEach loop for all entities with the given components
          *
@@ -85,6 +307,18 @@ namespace Fenrir
         template <typename... Components, typename Func>
         void GroupForEach(Func&& func);
 
+        /**
+         * @brief Parallel Group ForEach loop for all entities with the given components
+         * The same rules as ParallelForEach apply, but every entity in a chunk is known to match so no lookups are made
+         *
+         * @tparam Components to loop over
+         * @tparam Func to call on each entity with a reference to each component
+         * @param func to call on each entity
+         * @param grainSize the number of entities in each chunk
+         */
+        template <typename... Components, typename Func>
+        void ParallelGroupForEach(Func&& func, size_t grainSize = 1024);
+
         /**
          * @brief Get the View object
          *
@@ -94,6 +328,19 @@ namespace Fenrir
         template <typename... Components>
         auto View();
 
+        /**
+         * @brief Get a View object that only yields entities matching a Changed or Added filter
+         * The filter is checked on every entity of the view as it is walked, so walking it is O(N) in the size of the
+         * view like the filtered ForEach
+         *
+         * @tparam Components to get
+         * @tparam Filter the Changed or Added filter type
+         * @param filter the filter
+         * @return auto the filtered view
+         */
+        template <typename... Components, typename Filter>
+        auto View(Filter filter);
+
         /**
          * @brief Get the Group object
          *
@@ -103,33 +350,424 @@ namespace Fenrir
         template <typename... Components>
         auto Group();
 
+        /**
+         * @brief Set the thread pool that parallel loops are run on
+         *
+         * @param threadPool the thread pool, or nullptr to run parallel loops on the calling thread
+         */
+        void SetThreadPool(ThreadPool* threadPool);
+
+        /**
+         * @brief Get the command buffer of the calling thread, used to create and destroy entities or add and remove
+         * components from inside parallel systems. Every thread in the pool has its own buffer and all other threads
+         * share one, so the shared buffer should only be recorded into from the main thread
+         *
+         * @return CommandBuffer& the command buffer of the calling thread
+         */
+        CommandBuffer& GetCommandBuffer();
+
+        /**
+         * @brief Play back every thread's command buffer and clear them
+         * Commands are merged by the order of the scheduled work that recorded them, then by buffer and position, so
+         * the result is the same every run. This must not be called while systems are recording, the app calls it
+         * after each phase
+         *
+         */
+        void FlushCommands();
+
+        /**
+         * @brief Play back a single command buffer in the order it was recorded and clear it
+         *
+         * @param buffer the buffer to play back
+         */
+        void Playback(CommandBuffer& buffer);
+
       private:
+        /**
+         * @brief a reference to a command in one of the thread command buffers, sorted when merging the buffers
+         *
+         */
+        struct PendingCommand
+        {
+            uint64_t order;
+            uint32_t buffer;
+            uint32_t index;
+        };
+
+        /**
+         * @brief the entities of each interned name, kept up to date by the Name storage signals. It lives on the heap
+         * so the signals can point at it while the entity list is moved. Unnamed entities are not indexed, and every
+         * named entity remembers where it sits in its name's list so removing it is a swap with the last entry
+         *
+         */
+        struct NameIndex
+        {
+            struct Slot
+            {
+                uint32_t name;
+                uint32_t position;
+            };
+
+            std::unordered_map<uint32_t, std::vector<entt::entity>> entities;
+            std::unordered_map<entt::entity, Slot> names;
+
+            void OnConstruct(entt::registry& registry, entt::entity entity);
+            void OnUpdate(entt::registry& registry, entt::entity entity);
+            void OnDestroy(entt::registry& registry, entt::entity entity);
+
+            void Erase(entt::entity entity);
+        };
+
+        /**
+         * @brief the hierarchy sorted by depth, rebuilt when a Hierarchy is added or removed or a parent changes. It
+         * lives on the heap for the same reason as the name index
+         *
+         */
+        struct TransformHierarchy
+        {
+            std::vector<entt::entity> order; // every entity in the hierarchy, sorted by depth
+            std::vector<size_t> levels;      // the start of each depth in order, followed by the end
+            std::vector<entt::entity> walk;  // scratch used while rebuilding depths
+            uint32_t pass = 0;
+            bool changed = true;
+            PageTracker* pages = nullptr; // the hierarchy is written in place, so its writes are marked once forked
+
+            void OnChanged(entt::registry& registry, entt::entity entity);
+            void OnTransformUpdate(entt::registry& registry, entt::entity entity);
+        };
+
+        /**
+         * @brief the current change tick and the types being tracked, the signals stamp ComponentTicks from it. It
+         * lives on the heap for the same reason as the name index
+         *
+         */
+        struct ChangeTracker
+        {
+            std::atomic<uint32_t> tick = 1; // claimed from systems running in parallel
+            std::vector<std::type_index> trackedTypes;
+
+            template <typename T>
+            void OnConstruct(entt::registry& registry, entt::entity entity);
+
+            template <typename T>
+            void OnUpdate(entt::registry& registry, entt::entity entity);
+
+            template <typename T>
+            void OnDestroy(entt::registry& registry, entt::entity entity);
+        };
+
         entt::registry m_registry;
 
+        std::unique_ptr<NameIndex> m_nameIndex;
+
+        std::unique_ptr<ChangeTracker> m_changeTracker;
+
+        std::unique_ptr<TransformHierarchy> m_hierarchy;
+
+        // the living entities and the pages of the forked pools written to since the last fork, only made once the
+        // list is first forked so a list that is never forked pays nothing for it
+        std::unique_ptr<PageTracker> m_pages;
+
+        ThreadPool* m_threadPool = nullptr;
+
+        // one buffer per worker thread plus one for every other thread, in that order
+        std::vector<std::unique_ptr<CommandBuffer>> m_commandBuffers;
+
+        // reused between flushes so merging the buffers does not allocate once it has warmed up
+        std::vector<PendingCommand> m_pendingCommands;
+
+        // reused by the bulk create and destroy functions
+        std::vector<entt::entity> m_entityScratch;
+
+        std::vector<std::unique_ptr<LocalitySort>> m_localitySorts;
+        size_t m_nextLocalitySort = 0;
+
+        // on the heap so the signals can point at them while the entity list is moved
+        std::vector<std::unique_ptr<Observer>> m_observers;
+
+        /**
+         * @brief Apply a single recorded command, commands that target an entity that no longer exists are skipped
+         *
+         * @param buffer the buffer the command was recorded in
+         * @param command the command to apply
+         */
+        void ApplyCommand(CommandBuffer& buffer, const CommandBuffer::Command& command);
+
+        /**
+         * @brief Recompute the depth of every entity in the hierarchy and sort them by it. Entities whose parent no
+         * longer exists become roots
+         *
+         */
+        void RebuildHierarchy();
+
+        /**
+         * @brief Get the page tracker, making it on the first fork from the entities alive at that point
+         *
+         * @return the page tracker
+         */
+        PageTracker& GetPageTracker();
+
+        /**
+         * @brief Split the range [0, count) into chunks and run them on the thread pool, returning once every chunk
+         * has finished. The join is a single counter, so no allocations are made
+         *
+         * @tparam Func the chunk function type
+         * @param count the size of the range
+         * @param grainSize the size of each chunk
+         * @param func to call with the begin and end of each chunk
+         */
+        template <typename Func>
+        void ParallelFor(size_t count, size_t grainSize, Func&& func);
+
         friend class Entity;
+        friend class Snapshot;
+        friend class EntityListFork;
     };
 
+    template <typename... Prototypes>
+    std::vector<uint32_t> EntityList::CreateEntities(size_t count, const Prototypes&... prototypes)
+    {
+        m_entityScratch.resize(count);
+        m_registry.create(m_entityScratch.begin(), m_entityScratch.end());
+        if (m_pages)
+        {
+            for (const entt::entity entity : m_entityScratch)
+                m_pages->OnCreate(entity);
+        }
+
+        if constexpr (!(std::is_same_v<Prototypes, Transform> || ...))
+            m_registry.insert<Transform>(m_entityScratch.begin(), m_entityScratch.end(), Transform());
+
+        if constexpr (!(std::is_same_v<Prototypes, Name> || ...))
+            m_registry.insert<Name>(m_entityScratch.begin(), m_entityScratch.end(), Name());
+
+        (m_registry.insert<Prototypes>(m_entityScratch.begin(), m_entityScratch.end(), prototypes), ...);
+
+        std::vector<uint32_t> ids(count);
+        std::transform(m_entityScratch.begin(), m_entityScratch.end(), ids.begin(),
+                       [](entt::entity entity) { return static_cast<uint32_t>(entity); });
+
+        return ids;
+    }
+
+    template <typename It>
+    void EntityList::DestroyEntities(It first, It last)
+    {
+        m_entityScratch.clear();
+        for (; first != last; ++first)
+        {
+            const entt::entity entity = static_cast<entt::entity>(*first);
+            if (m_registry.valid(entity))
+                m_entityScratch.push_back(entity);
+        }
+
+        // destroying an entity twice is an error in the registry, so repeated ids are dropped first
+        std::sort(m_entityScratch.begin(), m_entityScratch.end());
+        m_entityScratch.erase(std::unique(m_entityScratch.begin(), m_entityScratch.end()), m_entityScratch.end());
+
+        if (m_pages)
+        {
+            for (const entt::entity entity : m_entityScratch)
+                m_pages->OnDestroy(entity);
+        }
+        m_registry.destroy(m_entityScratch.begin(), m_entityScratch.end());
+    }
+
     template <typename... Components, typename Func>
     void EntityList::ForEach(Func&& func)
     {
         m_registry.view<Components...>().each(std::forward<Func>(func));
     }
 
+    template <typename... Components, typename Filter, typename Func>
+    void EntityList::ForEach(Filter filter, Func&& func)
+    {
+        View<Components...>(filter).each(std::forward<Func>(func));
+    }
+
     template <typename... Components, typename Func>
     void EntityList::GroupForEach(Func&& func)
     {
         m_registry.group<Components...>().each(std::forward<Func>(func));
     }
 
+    template <typename... Components, typename Func>
+    void EntityList::ParallelForEach(Func&& func, size_t grainSize)
+    {
+        using Leading = std::tuple_element_t<0, std::tuple<Components...>>;
+
+        auto view = m_registry.view<Components...>();
+        const auto& leading = m_registry.storage<Leading>();
+        const entt::entity* entities = leading.data();
+
+        ParallelFor(leading.size(), grainSize, [&view, &func, entities](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const entt::entity entity = entities[i];
+                if (view.contains(entity))
+                {
+                    func(view.template get<Components>(entity)...);
+                }
+            }
+        });
+    }
+
+    template <typename... Components, typename Func>
+    void EntityList::ParallelGroupForEach(Func&& func, size_t grainSize)
+    {
+        auto group = m_registry.group<Components...>();
+        auto first = group.begin();
+
+        ParallelFor(group.size(), grainSize, [&group, &func, first](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const entt::entity entity = first[static_cast<std::ptrdiff_t>(i)];
+                func(group.template get<Components>(entity)...);
+            }
+        });
+    }
+
+    template <typename Func>
+    void EntityList::ParallelFor(size_t count, size_t grainSize, Func&& func)
+    {
+        grainSize = std::max<size_t>(grainSize, 1);
+
+        // each chunk gets its own order key so anything it records is merged in chunk order, work nested too deep to
+        // have keys left for its chunks runs on the calling thread instead so its order stays the same every run
+        const size_t maxChunks = TaskOrder::GetMaxChunks();
+
+        if (m_threadPool == nullptr || count <= grainSize || maxChunks == 0)
+        {
+            func(size_t{0}, count);
+            return;
+        }
+
+        grainSize = std::max(grainSize, (count + maxChunks - 1) / maxChunks);
+        const TaskOrder::ChunkKeys keys = TaskOrder::Split(static_cast<uint32_t>((count + grainSize - 1) / grainSize));
+
+        // the chunks run with the context of the calling work, wherever they end up running
+        void* const context = TaskContext::Current();
+
+        TaskCounter counter;
+        uint32_t chunk = 0;
+        for (size_t begin = 0; begin < count; begin += grainSize, ++chunk)
+        {
+            const size_t end = std::min(begin + grainSize, count);
+            const uint64_t key = keys.Get(chunk);
+            m_threadPool->Dispatch(
+                [&func, begin, end, key, context] {
+                    TaskOrder::Scope scope(key);
+                    TaskContext::Scope contextScope(context);
+                    func(begin, end);
+                },
+                counter);
+        }
+
+        m_threadPool->Wait(counter);
+    }
+
     template <typename... Components>
     auto EntityList::View()
     {
         return m_registry.view<Components...>();
     }
 
+    template <typename... Components, typename Filter>
+    auto EntityList::View(Filter filter)
+    {
+        auto view = m_registry.view<Components..., ComponentTicks<typename Filter::Component>>();
+        return FilteredView<decltype(view), Filter, Components...>(view, filter);
+    }
+
     template <typename... Components>
     auto EntityList::Group()
     {
         return m_registry.group<Components...>();
     }
+
+    template <typename T>
+    void EntityList::TrackChanges()
+    {
+        std::vector<std::type_index>& tracked = m_changeTracker->trackedTypes;
+        if (std::find(tracked.begin(), tracked.end(), std::type_index(typeid(T))) != tracked.end())
+            return;
+
+        tracked.emplace_back(typeid(T));
+
+        const uint32_t tick = m_changeTracker->tick.load(std::memory_order_relaxed);
+        for (const entt::entity entity : m_registry.view<T>())
+            m_registry.emplace_or_replace<ComponentTicks<T>>(entity, ComponentTicks<T>{tick, tick});
+
+        m_registry.on_construct<T>().template connect<&ChangeTracker::template OnConstruct<T>>(*m_changeTracker);
+        m_registry.on_update<T>().template connect<&ChangeTracker::template OnUpdate<T>>(*m_changeTracker);
+        m_registry.on_destroy<T>().template connect<&ChangeTracker::template OnDestroy<T>>(*m_changeTracker);
+    }
+
+    template <typename Lead, typename... Followers, typename Compare>
+    void EntityList::AddLocalitySort(Compare compare)
+    {
+        // whatever is already in the pools has never been sorted
+        auto job = std::make_unique<PoolLocalitySort<Compare, Lead, Followers...>>(
+            std::move(compare), m_registry.storage<Lead>().size(), m_pages);
+
+        // anything that adds, removes or changes a lead, or adds or removes a follower, can break the order
+        LocalitySort& sort = *job;
+        m_registry.on_construct<Lead>().template connect<&LocalitySort::OnChanged>(sort);
+        m_registry.on_update<Lead>().template connect<&LocalitySort::OnChanged>(sort);
+        m_registry.on_destroy<Lead>().template connect<&LocalitySort::OnChanged>(sort);
+        (m_registry.on_construct<Followers>().template connect<&LocalitySort::OnChanged>(sort), ...);
+        (m_registry.on_destroy<Followers>().template connect<&LocalitySort::OnChanged>(sort), ...);
+
+        m_localitySorts.push_back(std::move(job));
+    }
+
+    template <typename... Events>
+    Observer& EntityList::CreateObserver()
+    {
+        static_assert(sizeof...(Events) <= Observer::MaxEvents, "too many events for one observer");
+
+        auto observer = std::make_unique<Observer>();
+        (observer->Connect(m_registry, Events{}), ...);
+
+        m_observers.push_back(std::move(observer));
+        return *m_observers.back();
+    }
+
+    template <typename T>
+    void EntityList::MarkComponentChanged(uint32_t id)
+    {
+        if (ComponentTicks<T>* ticks = m_registry.try_get<ComponentTicks<T>>(static_cast<entt::entity>(id)))
+        {
+            ticks->changed = m_changeTracker->tick.load(std::memory_order_relaxed);
+        }
+
+        if (!m_pages)
+            return;
+
+        if (PageTracker::Pool* pages = m_pages->Find<T>())
+            pages->Mark(static_cast<entt::entity>(id));
+    }
+
+    template <typename T>
+    void EntityList::ChangeTracker::OnConstruct(entt::registry& registry, entt::entity entity)
+    {
+        const uint32_t now = tick.load(std::memory_order_relaxed);
+        registry.emplace_or_replace<ComponentTicks<T>>(entity, ComponentTicks<T>{now, now});
+    }
+
+    template <typename T>
+    void EntityList::ChangeTracker::OnUpdate(entt::registry& registry, entt::entity entity)
+    {
+        const uint32_t now = tick.load(std::memory_order_relaxed);
+        if (ComponentTicks<T>* ticks = registry.try_get<ComponentTicks<T>>(entity))
+            ticks->changed = now;
+        else
+            registry.emplace<ComponentTicks<T>>(entity, ComponentTicks<T>{now, now});
+    }
+
+    template <typename T>
+    void EntityList::ChangeTracker::OnDestroy(entt::registry& registry, entt::entity entity)
+    {
+        registry.remove<ComponentTicks<T>>(entity);
+    }
 } // namespace Fenrir
\ No newline at end of file
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Snapshot.hpp"
+
+namespace Fenrir
+{
+    class EntityList;
+
+    /**
+     * @brief An in memory copy of an entity list's living entities and the components of every type in the schema,
+     * used for rollback. They are copied into fixed size pages, and a fork made from the last fork or restore of the
+     * same entity list shares every page that was not written to since, so forking every tick only copies the dirty
+     * pages. Components changed in place through a reference must be marked with EntityList::MarkComponentChanged for
+     * the fork to see the change. Components of types outside the schema are not forked, so restoring leaves them as
+     * they are, except on entities that were created since the fork, which are destroyed, and entities that were
+     * destroyed since the fork, which come back with only the forked components
+     *
+     */
+    class EntityListFork
+    {
+      public:
+        static constexpr size_t PageSize = 16 * 1024;
+
+        /**
+         * @brief Construct a new empty Entity List Fork object
+         *
+         */
+        EntityListFork() = default;
+
+        /**
+         * @brief Fork an entity list
+         *
+         * @param entityList the entity list to fork
+         * @param base the last fork made from or restored to the entity list, to share unchanged pages with. Any
+         * other fork, or nullptr, is allowed but has every page copied
+         * @param schema the component types to fork
+         * @return EntityListFork the fork
+         */
+        static EntityListFork Create(EntityList& entityList, const EntityListFork* base = nullptr,
+                                     const SnapshotSchema& schema = SnapshotSchema::Default());
+
+        /**
+         * @brief Put an entity list back to the state it was forked in. Entities created since the fork are destroyed
+         * and destroyed ones are created again with the same ids. A pool whose entities are where they were when it
+         * was forked has only its dirty pages written back, any other forked pool is cleared and filled from the fork
+         *
+         * @param entityList the entity list the fork was made from
+         * @param schema the component types to restore, which should be the schema the fork was made with
+         * @return true if it was restored in place, false if any entities or pools had to be rebuilt
+         */
+        bool Restore(EntityList& entityList, const SnapshotSchema& schema = SnapshotSchema::Default()) const;
+
+        /**
+         * @brief Get the number of pages the fork holds
+         *
+         * @return size_t the number of pages
+         */
+        size_t GetPageCount() const;
+
+        /**
+         * @brief Get the number of pages that were copied when the fork was made rather than shared with the base
+         *
+         * @return size_t the number of copied pages
+         */
+        size_t GetCopiedPageCount() const;
+
+      private:
+        using Page = std::shared_ptr<const std::byte[]>;
+
+        /**
+         * @brief the entities and components of one type, page n of each holds the same elements. The living entities
+         * are a column without components
+         *
+         */
+        struct ColumnState
+        {
+            uint64_t id;
+            uint32_t elementSize;
+            size_t count;
+            size_t perPage;
+            std::vector<Page> entityPages;
+            std::vector<Page> componentPages;
+        };
+
+        uint64_t m_id = 0;
+        ColumnState m_living = {};
+        std::vector<ColumnState> m_columns;
+        size_t m_copiedPages = 0;
+
+        /**
+         * @brief Copy the dirty pages of a pool and share the rest with the base
+         *
+         * @param state the state to fill
+         * @param pool the pages of the pool, reset to this fork afterwards
+         * @param base the state of the same pool in the base fork, or nullptr
+         * @param baseId the id of the base fork
+         * @param column the column to copy components with, or nullptr for the living entities
+         * @param registry the registry that owns the pool
+         */
+        void Capture(ColumnState& state, PageTracker::Pool& pool, const ColumnState* base, uint64_t baseId,
+                     const SnapshotSchema::Column* column, entt::registry& registry);
+
+        /**
+         * @brief Find the state of a type id
+         *
+         * @param id the id of the type
+         * @return const ColumnState* the state, or nullptr if the type was not forked
+         */
+        const ColumnState* Find(uint64_t id) const;
+
+        /**
+         * @brief Check if a page of a pool may differ from the fork, which is every page unless the pool's marks are
+         * relative to this fork
+         *
+         * @param pool the pages of the pool
+         * @param page the index of the page
+         * @return true if the page has to be compared or written back
+         */
+        bool MayDiffer(const PageTracker::Pool& pool, size_t page) const;
+
+        /**
+         * @brief Check if a pool has the same entities at the same positions as the fork
+         *
+         * @param state the forked state of the pool
+         * @param pool the pages of the pool
+         * @return true if only components need to be written back
+         */
+        bool MatchesEntities(const ColumnState& state, const PageTracker::Pool& pool) const;
+    };
+} // namespace Fenrir
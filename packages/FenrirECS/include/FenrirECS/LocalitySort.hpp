@@ -0,0 +1,325 @@
+#pragma once
+
+#include <entt/entity/registry.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "PageTracker.hpp"
+
+namespace Fenrir
+{
+    /**
+     * @brief Keeps a lead pool sorted and a set of follower pools arranged to match it, a bounded number of steps at a
+     * time so a large pool never has to be sorted within a single frame. A step is one comparison, swap or follower
+     * entry, and the sort picks up where it stopped on the next call. Pools that change while a pass is under way are
+     * left to a further pass, which starts once the current one has finished. Every move is marked on the pages of
+     * forked pools, since the pools emit no signals for it
+     *
+     */
+    class LocalitySort
+    {
+      public:
+        /**
+         * @brief a pool where fewer than one in this many entities changed is treated as nearly sorted and insertion
+         * sorted, anything else is heap sorted so a pass never takes more than O(N log N) steps
+         *
+         */
+        static constexpr size_t NearlySortedRatio = 16;
+
+        virtual ~LocalitySort() = default;
+
+        /**
+         * @brief Check if the pools may be out of order, either because a pass is under way or they have changed
+         *
+         * @return true if there is work left to do
+         */
+        bool IsPending() const;
+
+        /**
+         * @brief Run the sort for up to a number of steps
+         *
+         * @param registry the registry that owns the pools
+         * @param maxSteps the most steps to run
+         * @return size_t the number of steps run, less than maxSteps only when the pools are in order
+         */
+        virtual size_t Run(entt::registry& registry, size_t maxSteps) = 0;
+
+        /**
+         * @brief Signal handler counting changes that can break the order
+         *
+         */
+        void OnChanged(entt::registry& registry, entt::entity entity);
+
+      protected:
+        static constexpr size_t None = std::numeric_limits<size_t>::max();
+
+        enum class Stage
+        {
+            Idle,
+            Insertion, // insert m_cursor into the sorted prefix, m_moving is where it currently is
+            Heapify,   // build a max heap from m_cursor down to zero, m_moving is the entry being sifted down
+            Extract,   // move the top of the heap to m_heapSize, m_moving is the entry being sifted down
+            Follow     // arrange follower m_follower by lead position m_cursor, m_placed entries are in place
+        };
+
+        const std::unique_ptr<PageTracker>* m_pages = nullptr; // the entity list's, which is null until it is forked
+        Stage m_stage = Stage::Idle;
+        size_t m_changes = 0;
+        size_t m_cursor = 0;
+        size_t m_moving = None;
+        size_t m_heapSize = 0;
+        size_t m_follower = 0;
+        size_t m_placed = 0;
+    };
+
+    /**
+     * @brief The locality sort of a lead component type and its followers
+     *
+     * @tparam Compare the compare function type, taking two Lead components or two entities
+     * @tparam Lead the component type whose pool decides the order
+     * @tparam Followers the component types whose pools follow the lead
+     */
+    template <typename Compare, typename Lead, typename... Followers>
+    class PoolLocalitySort final : public LocalitySort
+    {
+      public:
+        /**
+         * @brief Construct a new Pool Locality Sort object
+         *
+         * @param compare the compare function
+         * @param size the number of entities already in the lead pool, which have never been sorted
+         * @param pages the page tracker of the entity list, to mark the elements that are moved once it is forked
+         */
+        PoolLocalitySort(Compare compare, size_t size, const std::unique_ptr<PageTracker>& pages)
+            : m_compare(std::move(compare))
+        {
+            m_pages = &pages;
+            m_changes = size + 1;
+        }
+
+        size_t Run(entt::registry& registry, size_t maxSteps) override;
+
+      private:
+        Compare m_compare;
+
+        bool Less(entt::registry& registry, size_t lhs, size_t rhs);
+
+        void Swap(entt::registry& registry, size_t lhs, size_t rhs);
+
+        /**
+         * @brief Move the entry being sifted one level down the heap
+         *
+         * @param registry the registry
+         */
+        void SiftStep(entt::registry& registry);
+
+        /**
+         * @brief Arrange a follower pool to match the lead for up to a number of steps
+         *
+         * @tparam Follower the follower component type
+         * @param registry the registry
+         * @param maxSteps the most steps to run
+         * @return size_t the number of steps run
+         */
+        template <typename Follower>
+        size_t Follow(entt::registry& registry, size_t maxSteps);
+    };
+
+    template <typename Compare, typename Lead, typename... Followers>
+    size_t PoolLocalitySort<Compare, Lead, Followers...>::Run(entt::registry& registry, size_t maxSteps)
+    {
+        const size_t size = registry.storage<Lead>().size();
+
+        // the pools may have shrunk since the last call, positions past the end are dropped and the order they
+        // leave behind is fixed by the next pass
+        m_cursor = std::min(m_cursor, size);
+        m_heapSize = std::min(m_heapSize, size);
+        if (m_moving != None && m_moving >= size)
+            m_moving = None;
+
+        size_t steps = 0;
+        while (steps < maxSteps)
+        {
+            switch (m_stage)
+            {
+            case Stage::Idle:
+                if (m_changes == 0)
+                    return steps;
+
+                m_stage = (m_changes * NearlySortedRatio < size) ? Stage::Insertion : Stage::Heapify;
+                m_changes = 0;
+                m_cursor = (m_stage == Stage::Insertion) ? 1 : size / 2;
+                m_heapSize = size;
+                m_moving = None;
+                break;
+
+            case Stage::Insertion:
+                if (m_moving == None)
+                {
+                    if (m_cursor >= size)
+                    {
+                        m_stage = Stage::Follow;
+                        m_cursor = 0;
+                        break;
+                    }
+                    m_moving = m_cursor++;
+                }
+
+                ++steps;
+                if (m_moving > 0 && Less(registry, m_moving, m_moving - 1))
+                {
+                    Swap(registry, m_moving, m_moving - 1);
+                    --m_moving;
+                }
+                else
+                {
+                    m_moving = None;
+                }
+                break;
+
+            case Stage::Heapify:
+                if (m_moving == None)
+                {
+                    if (m_cursor == 0)
+                    {
+                        m_stage = Stage::Extract;
+                        break;
+                    }
+                    m_moving = --m_cursor;
+                }
+
+                ++steps;
+                SiftStep(registry);
+                break;
+
+            case Stage::Extract:
+                ++steps;
+                if (m_moving != None)
+                {
+                    SiftStep(registry);
+                    break;
+                }
+
+                if (m_heapSize <= 1)
+                {
+                    m_stage = Stage::Follow;
+                    m_cursor = 0;
+                    break;
+                }
+
+                Swap(registry, 0, --m_heapSize);
+                m_moving = 0;
+                break;
+
+            case Stage::Follow:
+                if (m_follower == sizeof...(Followers))
+                {
+                    m_follower = 0;
+                    m_cursor = 0;
+                    m_placed = 0;
+                    m_stage = Stage::Idle;
+                    break;
+                }
+
+                {
+                    size_t index = 0;
+                    ((index++ == m_follower ? (steps += Follow<Followers>(registry, maxSteps - steps)) : 0), ...);
+                }
+                break;
+            }
+        }
+
+        return steps;
+    }
+
+    template <typename Compare, typename Lead, typename... Followers>
+    bool PoolLocalitySort<Compare, Lead, Followers...>::Less(entt::registry& registry, size_t lhs, size_t rhs)
+    {
+        auto& lead = registry.storage<Lead>();
+        const entt::entity* entities = lead.data();
+
+        if constexpr (std::is_invocable_r_v<bool, Compare&, const Lead&, const Lead&>)
+            return m_compare(std::as_const(lead.get(entities[lhs])), std::as_const(lead.get(entities[rhs])));
+        else
+            return m_compare(entities[lhs], entities[rhs]);
+    }
+
+    template <typename Compare, typename Lead, typename... Followers>
+    void PoolLocalitySort<Compare, Lead, Followers...>::Swap(entt::registry& registry, size_t lhs, size_t rhs)
+    {
+        auto& lead = registry.storage<Lead>();
+        lead.swap_elements(lead.data()[lhs], lead.data()[rhs]);
+
+        if (PageTracker::Pool* pages = *m_pages ? (*m_pages)->Find<Lead>() : nullptr)
+        {
+            pages->MarkPosition(lhs);
+            pages->MarkPosition(rhs);
+        }
+    }
+
+    template <typename Compare, typename Lead, typename... Followers>
+    void PoolLocalitySort<Compare, Lead, Followers...>::SiftStep(entt::registry& registry)
+    {
+        size_t child = 2 * m_moving + 1;
+        if (child >= m_heapSize)
+        {
+            m_moving = None;
+            return;
+        }
+
+        if (child + 1 < m_heapSize && Less(registry, child, child + 1))
+            ++child;
+
+        if (Less(registry, m_moving, child))
+        {
+            Swap(registry, m_moving, child);
+            m_moving = child;
+        }
+        else
+        {
+            m_moving = None;
+        }
+    }
+
+    template <typename Compare, typename Lead, typename... Followers>
+    template <typename Follower>
+    size_t PoolLocalitySort<Compare, Lead, Followers...>::Follow(entt::registry& registry, size_t maxSteps)
+    {
+        auto& lead = registry.storage<Lead>();
+        auto& follower = registry.storage<Follower>();
+        PageTracker::Pool* pages = *m_pages ? (*m_pages)->Find<Follower>() : nullptr;
+
+        size_t steps = 0;
+        for (; steps < maxSteps && m_cursor < lead.size(); ++steps, ++m_cursor)
+        {
+            const entt::entity entity = lead.data()[m_cursor];
+            if (!follower.contains(entity) || m_placed >= follower.size())
+                continue;
+
+            if (follower.index(entity) != m_placed)
+            {
+                if (pages)
+                {
+                    pages->MarkPosition(m_placed);
+                    pages->MarkPosition(follower.index(entity));
+                }
+                follower.swap_elements(follower.data()[m_placed], entity);
+            }
+            ++m_placed;
+        }
+
+        if (m_cursor >= lead.size())
+        {
+            ++m_follower;
+            m_cursor = 0;
+            m_placed = 0;
+        }
+
+        return steps;
+    }
+} // namespace Fenrir
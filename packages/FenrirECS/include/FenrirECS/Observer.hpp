@@ -0,0 +1,207 @@
+#pragma once
+
+#include <entt/entity/registry.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace Fenrir
+{
+    /**
+     * @brief An observer event for when a component of type T is added to an entity
+     *
+     * @tparam T the type of component
+     */
+    template <typename T>
+    struct OnAdded
+    {
+        using Component = T;
+    };
+
+    /**
+     * @brief An observer event for when a component of type T is removed from an entity, or its entity is destroyed
+     *
+     * @tparam T the type of component
+     */
+    template <typename T>
+    struct OnRemoved
+    {
+        using Component = T;
+    };
+
+    /**
+     * @brief An observer event for when a component of type T is replaced or patched through the registry, a command
+     * buffer or EntityList::SetName. Changes made in place through a reference are not seen, use the Changed filter
+     * for those
+     *
+     * @tparam T the type of component
+     */
+    template <typename T>
+    struct OnUpdated
+    {
+        using Component = T;
+    };
+
+    /**
+     * @brief A set of entities that have had one of a list of events happen to them since it was last cleared, made
+     * with EntityList::CreateObserver. Each entity is recorded once however many events it sees, along with which
+     * events those were. Removing a component takes back what OnAdded and OnUpdated of its type recorded, and the
+     * entity is dropped once no event is left, so an entity also recorded by any other event is kept. An entity
+     * recorded by OnRemoved is kept even if its entity is destroyed so the ids of removed entities may no longer be
+     * valid. The entity list signals record into it, so it must only be read and cleared while no entities are being
+     * changed
+     *
+     */
+    class Observer
+    {
+      public:
+        static constexpr size_t MaxEvents = 32;
+
+        /**
+         * @brief Get the number of entities recorded
+         *
+         * @return size_t the number of entities
+         */
+        size_t GetCount() const;
+
+        /**
+         * @brief Check if nothing has been recorded
+         *
+         * @return true if empty
+         */
+        bool IsEmpty() const;
+
+        /**
+         * @brief Check if an entity has been recorded
+         *
+         * @param id the id of the entity
+         * @return true if it has been recorded
+         */
+        bool Contains(uint32_t id) const;
+
+        /**
+         * @brief Get every entity recorded, in the order they were first recorded apart from where one was dropped
+         *
+         * @return const std::vector<entt::entity>& the entities
+         */
+        const std::vector<entt::entity>& GetEntities() const;
+
+        /**
+         * @brief Call a function on every entity recorded and then clear them. The function must not add, remove or
+         * update any of the observed components
+         *
+         * @tparam Func the function type
+         * @param func to call with the id of each entity
+         */
+        template <typename Func>
+        void Consume(Func&& func);
+
+        /**
+         * @brief Forget every entity recorded
+         *
+         */
+        void Clear();
+
+      private:
+        /**
+         * @brief one event of the observer, the signals of the event are connected to it so they know which event
+         * they record
+         *
+         */
+        struct Recorder
+        {
+            Observer* observer;
+            uint32_t event; // the bit of the event
+            void (*disconnect)(entt::registry&, Recorder&);
+
+            void OnRecord(entt::registry& registry, entt::entity entity);
+            void OnForget(entt::registry& registry, entt::entity entity);
+        };
+
+        /**
+         * @brief where an entity is in m_entities and the events that recorded it
+         *
+         */
+        struct Slot
+        {
+            uint32_t position;
+            uint32_t events;
+        };
+
+        std::vector<entt::entity> m_entities;
+        std::unordered_map<entt::entity, Slot> m_slots;
+
+        // on the heap so the signals can point at them while more are added
+        std::vector<std::unique_ptr<Recorder>> m_recorders;
+
+        /**
+         * @brief Add the recorder of the next event
+         *
+         * @param disconnect disconnects the signals of the event, called when the observer is destroyed
+         * @return Recorder& the recorder
+         */
+        Recorder& AddRecorder(void (*disconnect)(entt::registry&, Recorder&));
+
+        void Record(entt::entity entity, uint32_t event);
+        void Forget(entt::entity entity, uint32_t event);
+
+        template <typename T>
+        void Connect(entt::registry& registry, OnAdded<T>);
+
+        template <typename T>
+        void Connect(entt::registry& registry, OnRemoved<T>);
+
+        template <typename T>
+        void Connect(entt::registry& registry, OnUpdated<T>);
+
+        void Disconnect(entt::registry& registry);
+
+        friend class EntityList;
+    };
+
+    template <typename Func>
+    void Observer::Consume(Func&& func)
+    {
+        for (const entt::entity entity : m_entities)
+            func(static_cast<uint32_t>(entity));
+
+        Clear();
+    }
+
+    template <typename T>
+    void Observer::Connect(entt::registry& registry, OnAdded<T>)
+    {
+        Recorder& recorder = AddRecorder([](entt::registry& r, Recorder& rec) {
+            r.on_construct<T>().disconnect(&rec);
+            r.on_destroy<T>().disconnect(&rec);
+        });
+
+        registry.on_construct<T>().template connect<&Recorder::OnRecord>(recorder);
+        registry.on_destroy<T>().template connect<&Recorder::OnForget>(recorder);
+    }
+
+    template <typename T>
+    void Observer::Connect(entt::registry& registry, OnRemoved<T>)
+    {
+        Recorder& recorder =
+            AddRecorder([](entt::registry& r, Recorder& rec) { r.on_destroy<T>().disconnect(&rec); });
+
+        registry.on_destroy<T>().template connect<&Recorder::OnRecord>(recorder);
+    }
+
+    template <typename T>
+    void Observer::Connect(entt::registry& registry, OnUpdated<T>)
+    {
+        Recorder& recorder = AddRecorder([](entt::registry& r, Recorder& rec) {
+            r.on_update<T>().disconnect(&rec);
+            r.on_destroy<T>().disconnect(&rec);
+        });
+
+        registry.on_update<T>().template connect<&Recorder::OnRecord>(recorder);
+        registry.on_destroy<T>().template connect<&Recorder::OnForget>(recorder);
+    }
+} // namespace Fenrir
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <entt/entity/registry.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <typeindex>
+#include <unordered_map>
+
+namespace Fenrir
+{
+    /**
+     * @brief Records which pages of the forked pools were written to since they were last forked or restored, so the
+     * next fork only copies those pages and shares the rest with the fork they are relative to. A page is a fixed
+     * number of positions in a pool. The living entities are kept in a pool of their own, which the entity list
+     * updates as it creates and destroys entities. Components added, replaced or removed through the registry are
+     * marked by the pool signals and the locality sorts mark the elements they move, components changed in place
+     * through a reference must be marked with EntityList::MarkComponentChanged. The entity list only makes one when
+     * it is first forked
+     *
+     */
+    class PageTracker
+    {
+      public:
+        /**
+         * @brief the pages of a single pool
+         *
+         */
+        class Pool
+        {
+          public:
+            /**
+             * @brief Construct a new Pool object, with a page for every position in the pool and every page dirty
+             *
+             * @param entities the entities of the pool, in position order
+             * @param perPage the number of positions in a page
+             */
+            Pool(const entt::sparse_set& entities, size_t perPage);
+
+            /**
+             * @brief Mark the page an entity is on, safe to call from several threads at once
+             *
+             * @param entity the entity, nothing is marked if it is not in the pool
+             */
+            void Mark(entt::entity entity);
+
+            /**
+             * @brief Mark the page of a position, safe to call from several threads at once. Positions past the last
+             * page are dirty until the next fork or restore, so they are not stored
+             *
+             * @param position the position in the pool
+             */
+            void MarkPosition(size_t position);
+
+            /**
+             * @brief Mark every page, for changes that touch too much of the pool to mark one at a time
+             *
+             */
+            void MarkAll();
+
+            /**
+             * @brief Check if a page was written to since the fork the pool is relative to
+             *
+             * @param page the index of the page
+             * @return true if the page may differ from the fork
+             */
+            bool IsDirty(size_t page) const;
+
+            /**
+             * @brief Get the fork the marks are relative to
+             *
+             * @return uint64_t the id of the fork, zero if every page has to be treated as dirty
+             */
+            uint64_t GetFork() const;
+
+            /**
+             * @brief Clear every mark after the pool was forked or restored
+             *
+             * @param fork the id of the fork the pool now matches
+             */
+            void Reset(uint64_t fork);
+
+            const entt::sparse_set& GetEntities() const;
+
+            size_t GetPerPage() const;
+
+            // signal handlers for the pool's component type
+            void OnConstruct(entt::registry& registry, entt::entity entity);
+            void OnUpdate(entt::registry& registry, entt::entity entity);
+            void OnDestroy(entt::registry& registry, entt::entity entity);
+
+          private:
+            const entt::sparse_set* m_entities;
+            size_t m_perPage;
+            uint64_t m_fork = 0;
+
+            // marked from parallel loops, only grown when the pool is made, forked or restored
+            std::unique_ptr<std::atomic<bool>[]> m_dirty;
+            size_t m_pageCount = 0;
+
+            /**
+             * @brief Make room for more pages, which start out dirty
+             *
+             * @param pageCount the number of pages needed
+             */
+            void Grow(size_t pageCount);
+        };
+
+        /**
+         * @brief Construct a new Page Tracker object, with the living entities tracked and no pools
+         *
+         */
+        PageTracker();
+
+        /**
+         * @brief Start tracking the pool of a component type, does nothing if it is already tracked
+         *
+         * @tparam T the type of component
+         * @param registry the registry that owns the pool
+         * @param perPage the number of positions in a page
+         * @return Pool& the pages of the pool
+         */
+        template <typename T>
+        Pool& Track(entt::registry& registry, size_t perPage);
+
+        /**
+         * @brief Find the pages of a component type
+         *
+         * @tparam T the type of component
+         * @return Pool* the pages, or nullptr if the type is not tracked
+         */
+        template <typename T>
+        Pool* Find();
+
+        /**
+         * @brief Get the pages of the living entities
+         *
+         * @return Pool& the pages
+         */
+        Pool& GetLiving();
+
+        /**
+         * @brief Add a created entity to the living entities
+         *
+         * @param entity the entity
+         */
+        void OnCreate(entt::entity entity);
+
+        /**
+         * @brief Remove an entity that is about to be destroyed from the living entities
+         *
+         * @param entity the entity
+         */
+        void OnDestroy(entt::entity entity);
+
+        /**
+         * @brief Remove every entity from the living entities
+         *
+         */
+        void ClearLiving();
+
+        /**
+         * @brief Replace the living entities, used when a fork puts back the entities it was made with
+         *
+         * @param entities the living entities in the order the fork holds them
+         * @param count the number of entities
+         */
+        void SetLiving(const entt::entity* entities, size_t count);
+
+      private:
+        entt::sparse_set m_living;
+        Pool m_livingPages;
+
+        // on the heap so the signals can point at them while the map grows
+        std::unordered_map<std::type_index, std::unique_ptr<Pool>> m_pools;
+    };
+
+    template <typename T>
+    PageTracker::Pool& PageTracker::Track(entt::registry& registry, size_t perPage)
+    {
+        std::unique_ptr<Pool>& pool = m_pools[std::type_index(typeid(T))];
+        if (pool)
+            return *pool;
+
+        pool = std::make_unique<Pool>(registry.storage<T>(), perPage);
+        registry.on_construct<T>().template connect<&Pool::OnConstruct>(*pool);
+        registry.on_update<T>().template connect<&Pool::OnUpdate>(*pool);
+        registry.on_destroy<T>().template connect<&Pool::OnDestroy>(*pool);
+
+        return *pool;
+    }
+
+    template <typename T>
+    PageTracker::Pool* PageTracker::Find()
+    {
+        auto it = m_pools.find(std::type_index(typeid(T)));
+        return it != m_pools.end() ? it->second.get() : nullptr;
+    }
+} // namespace Fenrir
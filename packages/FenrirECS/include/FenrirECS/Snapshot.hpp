@@ -0,0 +1,247 @@
+#pragma once
+
+#include <entt/entity/registry.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "PageTracker.hpp"
+
+namespace Fenrir
+{
+    class EntityList;
+
+    /**
+     * @brief The component types that are written to and read from snapshots
+     * Each type is identified in the file by a hash of the name it was registered with, so the name must stay the
+     * same between builds while the type itself can be renamed freely. Types in a file that are not in the schema are
+     * skipped when loading
+     *
+     */
+    class SnapshotSchema
+    {
+      public:
+        /**
+         * @brief Construct a new empty Snapshot Schema object
+         *
+         */
+        SnapshotSchema() = default;
+
+        /**
+         * @brief Get the schema used when none is given, it has the default components registered and more can be
+         * added to it
+         *
+         * @return SnapshotSchema& the default schema
+         */
+        static SnapshotSchema& Default();
+
+        /**
+         * @brief Register a component type that is written to the file as raw bytes, so it must be trivially
+         * copyable and must not hold pointers or anything else that is only valid in the running program
+         *
+         * @tparam T the type of component
+         * @param name the name that identifies the type in the file
+         * @return SnapshotSchema& the schema
+         */
+        template <typename T>
+        SnapshotSchema& Register(std::string_view name);
+
+        /**
+         * @brief Register the Name component, which is written as strings and interned again when loaded
+         *
+         * @param name the name that identifies the type in the file
+         * @return SnapshotSchema& the schema
+         */
+        SnapshotSchema& RegisterName(std::string_view name);
+
+      private:
+        /**
+         * @brief how a single component type is written and read, the element size is zero for types that are not
+         * written raw. The memory functions copy components as raw bytes for forks, which never leave the process, and
+         * track which pages of the pool were written to between forks
+         *
+         */
+        struct Column
+        {
+            uint64_t id;
+            uint32_t elementSize;
+            void (*collect)(entt::registry&, std::vector<entt::entity>&);
+            void (*write)(entt::registry&, const std::vector<entt::entity>&, std::ostream&);
+            bool (*read)(entt::registry&, const std::vector<entt::entity>&, const std::byte*, size_t);
+
+            uint32_t memorySize;
+            void (*gather)(entt::registry&, const entt::entity*, size_t, std::byte*);
+            size_t (*restore)(entt::registry&, const entt::entity*, size_t, const std::byte*);
+            void (*insert)(entt::registry&, const entt::entity*, size_t, const std::byte*);
+            void (*clear)(entt::registry&);
+            PageTracker::Pool& (*track)(entt::registry&, PageTracker&, size_t);
+        };
+
+        std::vector<Column> m_columns;
+
+        /**
+         * @brief Hash a type name into the id stored in the file
+         *
+         * @param name the name to hash
+         * @return uint64_t the id
+         */
+        static uint64_t HashName(std::string_view name);
+
+        /**
+         * @brief Find the column of a type id
+         *
+         * @param id the id of the type
+         * @return const Column* the column, or nullptr if the type is not registered
+         */
+        const Column* Find(uint64_t id) const;
+
+        /**
+         * @brief Fill in the memory functions of a column
+         *
+         * @tparam T the type of component
+         * @param column the column
+         */
+        template <typename T>
+        static void SetMemoryFuncs(Column& column);
+
+        friend class Snapshot;
+        friend class EntityListFork;
+    };
+
+    /**
+     * @brief Saves and loads entity lists as a versioned binary file
+     * Every registered component type is stored as a column block of entity ids followed by the components, and raw
+     * columns are aligned in the file so loading can memory map it and bulk insert straight from the mapped pages.
+     * Entity ids are kept, so components that store ids, such as Hierarchy, still point at the right entities. Files
+     * are only readable on machines with the same byte order and component layout, which the element sizes check
+     *
+     */
+    class Snapshot
+    {
+      public:
+        static constexpr uint32_t Version = 1;
+
+        /**
+         * @brief Save every entity that has at least one registered component
+         *
+         * @param entityList the entity list to save
+         * @param path the file to write
+         * @param schema the component types to save
+         * @return true if the file was written
+         */
+        static bool Save(EntityList& entityList, const std::string& path,
+                         const SnapshotSchema& schema = SnapshotSchema::Default());
+
+        /**
+         * @brief Load a snapshot, replacing everything in the entity list
+         *
+         * @param entityList the entity list to load into
+         * @param path the file to read
+         * @param schema the component types to load
+         * @return true if the file was read, the entity list is left empty if it was not
+         */
+        static bool Load(EntityList& entityList, const std::string& path,
+                         const SnapshotSchema& schema = SnapshotSchema::Default());
+    };
+
+    template <typename T>
+    SnapshotSchema& SnapshotSchema::Register(std::string_view name)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "snapshot components are written raw and must be trivially "
+                                                       "copyable");
+        static_assert(!std::is_empty_v<T>, "empty components have no data to write");
+
+        Column column;
+        column.id = HashName(name);
+        column.elementSize = static_cast<uint32_t>(sizeof(T));
+
+        column.collect = [](entt::registry& registry, std::vector<entt::entity>& entities) {
+            const auto& storage = registry.storage<T>();
+            entities.assign(storage.data(), storage.data() + storage.size());
+        };
+
+        column.write = [](entt::registry& registry, const std::vector<entt::entity>& entities, std::ostream& out) {
+            const auto& storage = registry.storage<T>();
+            for (const entt::entity entity : entities)
+                out.write(reinterpret_cast<const char*>(&storage.get(entity)), sizeof(T));
+        };
+
+        column.read = [](entt::registry& registry, const std::vector<entt::entity>& entities, const std::byte* data,
+                         size_t size) {
+            const auto& storage = registry.storage<T>();
+            if (size != entities.size() * sizeof(T) ||
+                std::any_of(entities.begin(), entities.end(), [&](entt::entity e) { return storage.contains(e); }))
+                return false;
+
+            if (reinterpret_cast<uintptr_t>(data) % alignof(T) == 0)
+            {
+                // the column is aligned in the file, so the mapped pages can be inserted without copying them first
+                registry.insert<T>(entities.begin(), entities.end(), reinterpret_cast<const T*>(data));
+            }
+            else
+            {
+                std::vector<T> components(entities.size());
+                std::memcpy(components.data(), data, size);
+                registry.insert<T>(entities.begin(), entities.end(), components.begin());
+            }
+
+            return true;
+        };
+
+        SetMemoryFuncs<T>(column);
+        m_columns.push_back(column);
+        return *this;
+    }
+
+    template <typename T>
+    void SnapshotSchema::SetMemoryFuncs(Column& column)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "forked components are copied raw");
+        static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "forked components are stored in byte pages");
+
+        column.memorySize = static_cast<uint32_t>(sizeof(T));
+
+        column.gather = [](entt::registry& registry, const entt::entity* entities, size_t count, std::byte* out) {
+            const auto& storage = registry.storage<T>();
+            for (size_t i = 0; i < count; ++i)
+                std::memcpy(out + i * sizeof(T), &storage.get(entities[i]), sizeof(T));
+        };
+
+        // only components that differ are written and patched, so observers only hear about real changes
+        column.restore = [](entt::registry& registry, const entt::entity* entities, size_t count,
+                            const std::byte* data) {
+            auto& storage = registry.storage<T>();
+            size_t restored = 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                T& component = storage.get(entities[i]);
+                if (std::memcmp(&component, data + i * sizeof(T), sizeof(T)) == 0)
+                    continue;
+
+                std::memcpy(&component, data + i * sizeof(T), sizeof(T));
+                registry.patch<T>(entities[i]);
+                ++restored;
+            }
+
+            return restored;
+        };
+
+        column.insert = [](entt::registry& registry, const entt::entity* entities, size_t count,
+                           const std::byte* data) {
+            registry.insert<T>(entities, entities + count, reinterpret_cast<const T*>(data));
+        };
+
+        column.clear = [](entt::registry& registry) { registry.clear<T>(); };
+
+        column.track = [](entt::registry& registry, PageTracker& pages, size_t perPage) -> PageTracker::Pool& {
+            return pages.Track<T>(registry, perPage);
+        };
+    }
+} // namespace Fenrir
@@ -0,0 +1,123 @@
+#include "FenrirECS/CommandBuffer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+
+#include "FenrirScheduler/TaskOrder.hpp"
+
+namespace Fenrir
+{
+    namespace
+    {
+        std::atomic<uint32_t> s_nextBufferId = 1;
+    } // namespace
+
+    CommandBuffer::CommandBuffer() : m_id(s_nextBufferId.fetch_add(1, std::memory_order_relaxed))
+    {
+    }
+
+    CommandBuffer::~CommandBuffer()
+    {
+        Clear();
+    }
+
+    DeferredEntity CommandBuffer::CreateEntity()
+    {
+        DeferredEntity entity{m_deferredCount++, m_id};
+        Record(CommandType::Create, entity.index, true);
+        return entity;
+    }
+
+    void CommandBuffer::DestroyEntity(uint32_t id)
+    {
+        Record(CommandType::Destroy, id, false);
+    }
+
+    void CommandBuffer::DestroyEntity(DeferredEntity entity)
+    {
+        CheckOwner(entity);
+        Record(CommandType::Destroy, entity.index, true);
+    }
+
+    bool CommandBuffer::IsEmpty() const
+    {
+        return m_commands.empty();
+    }
+
+    size_t CommandBuffer::GetCommandCount() const
+    {
+        return m_commands.size();
+    }
+
+    void CommandBuffer::Clear()
+    {
+        // components that were played back have been moved from, but still need destroying
+        for (Command& command : m_commands)
+        {
+            if (command.destroy)
+                command.destroy(command.payload);
+        }
+
+        m_commands.clear();
+        m_blockIndex = 0;
+        m_blockOffset = 0;
+        m_deferredCount = 0;
+    }
+
+    void CommandBuffer::Record(CommandType type, uint32_t target, bool deferred, void* payload, ApplyFunc apply,
+                               DestroyFunc destroy)
+    {
+        Command command;
+        command.order = TaskOrder::Current();
+        command.sequence = static_cast<uint32_t>(m_commands.size());
+        command.target = target;
+        command.type = type;
+        command.deferred = deferred;
+        command.payload = payload;
+        command.apply = apply;
+        command.destroy = destroy;
+
+        m_commands.push_back(command);
+    }
+
+    void CommandBuffer::CheckOwner(DeferredEntity entity) const
+    {
+        if (entity.buffer != m_id)
+            throw std::invalid_argument("deferred entity used with a command buffer that did not create it");
+    }
+
+    void* CommandBuffer::Allocate(size_t size, size_t alignment)
+    {
+        for (;;)
+        {
+            if (m_blockIndex < m_blocks.size())
+            {
+                Block& block = m_blocks[m_blockIndex];
+                const uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+                const size_t offset = ((base + m_blockOffset + alignment - 1) & ~(alignment - 1)) - base;
+                if (offset + size <= block.size)
+                {
+                    m_blockOffset = offset + size;
+                    return block.data.get() + offset;
+                }
+
+                if (m_blockIndex + 1 < m_blocks.size())
+                {
+                    ++m_blockIndex;
+                    m_blockOffset = 0;
+                    continue;
+                }
+            }
+
+            // components that are larger than a block get a block of their own
+            Block block;
+            block.size = std::max(BlockSize, size + alignment);
+            block.data = std::make_unique<std::byte[]>(block.size);
+            m_blocks.push_back(std::move(block));
+            m_blockIndex = m_blocks.size() - 1;
+            m_blockOffset = 0;
+        }
+    }
+} // namespace Fenrir
@@ -2,13 +2,56 @@
 
 #include "FenrirECS/Entity.hpp"
 
+#include <chrono>
+#include <tuple>
+#include <utility>
+
 namespace Fenrir
 {
+    namespace
+    {
+        constexpr uint32_t UnknownDepth = 0xFFFFFFFF;
+        constexpr uint32_t VisitingDepth = 0xFFFFFFFE;
+
+        // the number of entities in each chunk when a depth of the hierarchy is split across the thread pool
+        constexpr size_t HierarchyGrainSize = 256;
+
+        // the number of steps a locality sort runs between checks of the time budget
+        constexpr size_t LocalitySortSlice = 1024;
+
+        Math::Mat4 LocalMatrix(const Transform& transform)
+        {
+            Math::Mat4 matrix = Math::Translate(Math::Mat4(1.0f), transform.pos);
+            matrix *= Math::Mat4Cast(transform.rot);
+            return Math::Scale(matrix, transform.scale);
+        }
+    } // namespace
+
+    EntityList::EntityList()
+        : m_registry(), m_nameIndex(std::make_unique<NameIndex>()), m_changeTracker(std::make_unique<ChangeTracker>()),
+          m_hierarchy(std::make_unique<TransformHierarchy>()), m_pages(),
+          m_threadPool(nullptr), m_commandBuffers(), m_pendingCommands(), m_entityScratch()
+    {
+        m_commandBuffers.push_back(std::make_unique<CommandBuffer>());
+
+        m_registry.on_construct<Name>().connect<&NameIndex::OnConstruct>(*m_nameIndex);
+        m_registry.on_update<Name>().connect<&NameIndex::OnUpdate>(*m_nameIndex);
+        m_registry.on_destroy<Name>().connect<&NameIndex::OnDestroy>(*m_nameIndex);
+
+        m_registry.on_construct<Hierarchy>().connect<&TransformHierarchy::OnChanged>(*m_hierarchy);
+        m_registry.on_destroy<Hierarchy>().connect<&TransformHierarchy::OnChanged>(*m_hierarchy);
+        m_registry.on_update<Transform>().connect<&TransformHierarchy::OnTransformUpdate>(*m_hierarchy);
+    }
+
     Entity EntityList::CreateEntity()
     {
-        Entity entity(static_cast<uint32_t>(m_registry.create()), this);
+        const entt::entity entity = m_registry.create();
+        if (m_pages)
+            m_pages->OnCreate(entity);
+        m_registry.emplace<Transform>(entity);
+        m_registry.emplace<Name>(entity);
 
-        return entity;
+        return Entity(static_cast<uint32_t>(entity), this);
     }
 
     Entity EntityList::GetEntity(uint32_t id)
@@ -25,16 +68,20 @@ namespace Fenrir
     {
         if (m_registry.valid(static_cast<entt::entity>(id)))
         {
+            if (m_pages)
+                m_pages->OnDestroy(static_cast<entt::entity>(id));
             m_registry.destroy(static_cast<entt::entity>(id));
         }
     }
 
     void EntityList::DestroyEntity(Entity entity)
     {
-        if (m_registry.valid(static_cast<entt::entity>(entity.GetId())))
-        {
-            m_registry.destroy(static_cast<entt::entity>(entity.GetId()));
-        }
+        DestroyEntity(entity.GetId());
+    }
+
+    void EntityList::DestroyEntities(const std::vector<uint32_t>& ids)
+    {
+        DestroyEntities(ids.begin(), ids.end());
     }
 
     bool EntityList::HasEntity(uint32_t id)
@@ -42,9 +89,463 @@ namespace Fenrir
         return m_registry.valid(static_cast<entt::entity>(id));
     }
 
+    void EntityList::SetName(uint32_t id, std::string_view name)
+    {
+        const entt::entity entity = static_cast<entt::entity>(id);
+        if (m_registry.valid(entity))
+        {
+            m_registry.emplace_or_replace<Name>(entity, name);
+        }
+    }
+
+    Entity EntityList::FindEntityByName(std::string_view name)
+    {
+        // a name that was never interned cannot belong to any entity, and checking does not grow the pool
+        const uint32_t nameId = StringPool::Global().Find(name);
+        if (nameId == StringPool::InvalidId)
+            return Entity();
+
+        auto it = m_nameIndex->entities.find(nameId);
+        if (it == m_nameIndex->entities.end())
+            return Entity();
+
+        return Entity(static_cast<uint32_t>(it->second.front()), this);
+    }
+
+    bool EntityList::SetParent(uint32_t child, uint32_t parent)
+    {
+        const entt::entity childEntity = static_cast<entt::entity>(child);
+        const entt::entity parentEntity = static_cast<entt::entity>(parent);
+        if (!m_registry.valid(childEntity) || !m_registry.valid(parentEntity) || childEntity == parentEntity)
+            return false;
+
+        // walk up from the new parent, if we reach the child it would become its own ancestor
+        for (const Hierarchy* ancestor = m_registry.try_get<Hierarchy>(parentEntity); ancestor != nullptr;)
+        {
+            if (ancestor->parent == Hierarchy::NullParent)
+                break;
+
+            if (ancestor->parent == child)
+                return false;
+
+            ancestor = m_registry.try_get<Hierarchy>(static_cast<entt::entity>(ancestor->parent));
+        }
+
+        for (const entt::entity entity : {childEntity, parentEntity})
+        {
+            if (!m_registry.all_of<Hierarchy>(entity))
+                m_registry.emplace<Hierarchy>(entity);
+
+            if (!m_registry.all_of<WorldTransform>(entity))
+                m_registry.emplace<WorldTransform>(entity);
+        }
+
+        Hierarchy& hierarchy = m_registry.get<Hierarchy>(childEntity);
+        hierarchy.parent = parent;
+        hierarchy.dirty = true;
+        m_hierarchy->changed = true;
+        MarkComponentChanged<Hierarchy>(child);
+
+        return true;
+    }
+
+    void EntityList::ClearParent(uint32_t child)
+    {
+        const entt::entity entity = static_cast<entt::entity>(child);
+        if (!m_registry.valid(entity))
+            return;
+
+        if (!m_registry.all_of<WorldTransform>(entity))
+            m_registry.emplace<WorldTransform>(entity);
+
+        if (!m_registry.all_of<Hierarchy>(entity))
+            m_registry.emplace<Hierarchy>(entity);
+
+        Hierarchy& hierarchy = m_registry.get<Hierarchy>(entity);
+        if (hierarchy.parent != Hierarchy::NullParent)
+        {
+            hierarchy.parent = Hierarchy::NullParent;
+            hierarchy.dirty = true;
+            m_hierarchy->changed = true;
+            MarkComponentChanged<Hierarchy>(child);
+        }
+    }
+
+    void EntityList::MarkTransformDirty(uint32_t id)
+    {
+        if (Hierarchy* hierarchy = m_registry.try_get<Hierarchy>(static_cast<entt::entity>(id)))
+        {
+            hierarchy->dirty = true;
+            MarkComponentChanged<Hierarchy>(id);
+        }
+    }
+
+    void EntityList::UpdateWorldTransforms()
+    {
+        if (m_hierarchy->changed)
+            RebuildHierarchy();
+
+        const uint32_t pass = ++m_hierarchy->pass;
+
+        auto& nodes = m_registry.storage<Hierarchy>();
+        auto& locals = m_registry.storage<Transform>();
+        auto& worlds = m_registry.storage<WorldTransform>();
+        const std::vector<entt::entity>& order = m_hierarchy->order;
+        const std::vector<size_t>& levels = m_hierarchy->levels;
+        PageTracker::Pool* nodePages = m_pages ? m_pages->Find<Hierarchy>() : nullptr;
+        PageTracker::Pool* worldPages = m_pages ? m_pages->Find<WorldTransform>() : nullptr;
+
+        for (size_t level = 0; level + 1 < levels.size(); ++level)
+        {
+            const size_t levelBegin = levels[level];
+            const size_t levelSize = levels[level + 1] - levelBegin;
+
+            // a depth only reads the depth above it, which has already finished, so its entities are independent
+            ParallelFor(levelSize, HierarchyGrainSize, [&, levelBegin, pass](size_t begin, size_t end) {
+                for (size_t i = levelBegin + begin; i < levelBegin + end; ++i)
+                {
+                    const entt::entity entity = order[i];
+                    Hierarchy& hierarchy = nodes.get(entity);
+
+                    const entt::entity parent = static_cast<entt::entity>(hierarchy.parent);
+                    const bool hasParent = hierarchy.parent != Hierarchy::NullParent && worlds.contains(parent);
+                    const bool parentUpdated = hasParent && nodes.get(parent).updatedPass == pass;
+
+                    if ((!hierarchy.dirty && !parentUpdated) || !locals.contains(entity) || !worlds.contains(entity))
+                        continue;
+
+                    const Math::Mat4 local = LocalMatrix(locals.get(entity));
+                    worlds.get(entity).matrix = hasParent ? worlds.get(parent).matrix * local : local;
+
+                    // a dirty entity had its own Transform written in place, which change detection has not seen yet
+                    if (hierarchy.dirty)
+                        MarkComponentChanged<Transform>(static_cast<uint32_t>(entity));
+
+                    hierarchy.dirty = false;
+                    hierarchy.updatedPass = pass;
+
+                    if (nodePages)
+                        nodePages->Mark(entity);
+                    if (worldPages)
+                        worldPages->Mark(entity);
+                }
+            });
+        }
+    }
+
+    void EntityList::RebuildHierarchy()
+    {
+        auto& nodes = m_registry.storage<Hierarchy>();
+        const entt::entity* entities = nodes.data();
+        const size_t count = nodes.size();
+        std::vector<entt::entity>& walk = m_hierarchy->walk;
+
+        for (size_t i = 0; i < count; ++i)
+            nodes.get(entities[i]).depth = UnknownDepth;
+
+        if (PageTracker::Pool* pages = m_pages ? m_pages->Find<Hierarchy>() : nullptr)
+            pages->MarkAll();
+
+        // walk up from each entity until an ancestor with a known depth, then fill in the depths on the way back down
+        // so every entity is only walked over once
+        uint32_t maxDepth = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            walk.clear();
+            uint32_t depth = 0;
+            for (entt::entity current = entities[i];;)
+            {
+                Hierarchy& hierarchy = nodes.get(current);
+                if (hierarchy.depth == VisitingDepth)
+                {
+                    // the parents loop back on themselves, which can only happen if they were written directly, so
+                    // the loop is cut at the entity that closed it
+                    Hierarchy& last = nodes.get(walk.back());
+                    last.parent = Hierarchy::NullParent;
+                    last.dirty = true;
+                    break;
+                }
+
+                if (hierarchy.depth != UnknownDepth)
+                {
+                    depth = hierarchy.depth + 1;
+                    break;
+                }
+
+                hierarchy.depth = VisitingDepth;
+                walk.push_back(current);
+
+                const entt::entity parent = static_cast<entt::entity>(hierarchy.parent);
+                if (hierarchy.parent == Hierarchy::NullParent || !m_registry.valid(parent) || !nodes.contains(parent))
+                {
+                    if (hierarchy.parent != Hierarchy::NullParent)
+                    {
+                        // the parent was destroyed or left the hierarchy, so this entity becomes a root
+                        hierarchy.parent = Hierarchy::NullParent;
+                        hierarchy.dirty = true;
+                    }
+                    break;
+                }
+
+                current = parent;
+            }
+
+            for (auto it = walk.rbegin(); it != walk.rend(); ++it, ++depth)
+                nodes.get(*it).depth = depth;
+
+            maxDepth = std::max(maxDepth, depth);
+        }
+
+        // counting sort by depth, so each depth is a contiguous range of the order
+        std::vector<size_t>& levels = m_hierarchy->levels;
+        levels.assign(count > 0 ? maxDepth + 1 : 0, 0);
+        for (size_t i = 0; i < count; ++i)
+            ++levels[nodes.get(entities[i]).depth];
+
+        size_t offset = 0;
+        for (size_t& level : levels)
+            offset += std::exchange(level, offset);
+        levels.push_back(offset);
+
+        std::vector<entt::entity>& order = m_hierarchy->order;
+        order.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const uint32_t depth = nodes.get(entities[i]).depth;
+            order[levels[depth]++] = entities[i];
+        }
+
+        // placing the entities moved each start to the next one, so shift them back
+        for (size_t level = levels.size() - 1; level > 0; --level)
+            levels[level] = levels[level - 1];
+        if (!levels.empty())
+            levels[0] = 0;
+
+        m_hierarchy->changed = false;
+    }
+
+    size_t EntityList::RunLocalityMaintenance(double budget)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        // the sort at the front of the rotation keeps getting slices until it finishes or the budget runs out, and the
+        // next call resumes it, so no sort is starved by the ones after it
+        size_t finished = 0;
+        for (size_t visited = 0; visited < m_localitySorts.size(); ++visited)
+        {
+            LocalitySort& job = *m_localitySorts[m_nextLocalitySort];
+
+            bool outOfTime = false;
+            while (job.IsPending())
+            {
+                if (job.Run(m_registry, LocalitySortSlice) < LocalitySortSlice)
+                {
+                    ++finished;
+                    break;
+                }
+
+                if (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >= budget)
+                {
+                    outOfTime = true;
+                    break;
+                }
+            }
+
+            if (outOfTime)
+                break;
+
+            m_nextLocalitySort = (m_nextLocalitySort + 1) % m_localitySorts.size();
+        }
+
+        return finished;
+    }
+
+    uint32_t EntityList::GetChangeTick() const
+    {
+        return m_changeTracker->tick.load(std::memory_order_relaxed);
+    }
+
+    uint32_t EntityList::ClaimChangeTick()
+    {
+        return m_changeTracker->tick.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void EntityList::AdvanceChangeTick()
+    {
+        m_changeTracker->tick.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void EntityList::DestroyObserver(Observer& observer)
+    {
+        auto it = std::find_if(m_observers.begin(), m_observers.end(),
+                               [&observer](const std::unique_ptr<Observer>& o) { return o.get() == &observer; });
+        if (it == m_observers.end())
+            return;
+
+        observer.Disconnect(m_registry);
+        m_observers.erase(it);
+    }
+
     void EntityList::Clear()
     {
+        if (m_pages)
+            m_pages->ClearLiving();
         m_registry.clear();
     }
 
+    PageTracker& EntityList::GetPageTracker()
+    {
+        if (m_pages)
+            return *m_pages;
+
+        // nothing was recorded before the first fork, so the living entities are gathered once here
+        m_pages = std::make_unique<PageTracker>();
+        for (const auto [entity] : m_registry.storage<entt::entity>().each())
+            m_pages->OnCreate(entity);
+
+        m_hierarchy->pages = m_pages.get();
+        return *m_pages;
+    }
+
+    void EntityList::SetThreadPool(ThreadPool* threadPool)
+    {
+        m_threadPool = threadPool;
+
+        // buffers are only ever added so commands that have already been recorded are never lost
+        const size_t bufferCount = threadPool ? threadPool->GetThreadCount() + 1 : 1;
+        while (m_commandBuffers.size() < bufferCount)
+            m_commandBuffers.push_back(std::make_unique<CommandBuffer>());
+    }
+
+    CommandBuffer& EntityList::GetCommandBuffer()
+    {
+        if (m_threadPool == nullptr)
+            return *m_commandBuffers.back();
+
+        // the pool returns its thread count for threads outside of it, which is the last buffer
+        return *m_commandBuffers[m_threadPool->GetCurrentWorkerIndex()];
+    }
+
+    void EntityList::FlushCommands()
+    {
+        m_pendingCommands.clear();
+        for (size_t buffer = 0; buffer < m_commandBuffers.size(); ++buffer)
+        {
+            const std::vector<CommandBuffer::Command>& commands = m_commandBuffers[buffer]->m_commands;
+            for (size_t index = 0; index < commands.size(); ++index)
+            {
+                m_pendingCommands.push_back(
+                    {commands[index].order, static_cast<uint32_t>(buffer), static_cast<uint32_t>(index)});
+            }
+        }
+
+        if (m_pendingCommands.empty())
+            return;
+
+        std::sort(m_pendingCommands.begin(), m_pendingCommands.end(),
+                  [](const PendingCommand& lhs, const PendingCommand& rhs) {
+                      return std::tie(lhs.order, lhs.buffer, lhs.index) < std::tie(rhs.order, rhs.buffer, rhs.index);
+                  });
+
+        for (auto& buffer : m_commandBuffers)
+            buffer->m_created.assign(buffer->m_deferredCount, entt::null);
+
+        for (const PendingCommand& pending : m_pendingCommands)
+        {
+            CommandBuffer& buffer = *m_commandBuffers[pending.buffer];
+            ApplyCommand(buffer, buffer.m_commands[pending.index]);
+        }
+
+        for (auto& buffer : m_commandBuffers)
+            buffer->Clear();
+    }
+
+    void EntityList::Playback(CommandBuffer& buffer)
+    {
+        buffer.m_created.assign(buffer.m_deferredCount, entt::null);
+
+        for (const CommandBuffer::Command& command : buffer.m_commands)
+            ApplyCommand(buffer, command);
+
+        buffer.Clear();
+    }
+
+    void EntityList::ApplyCommand(CommandBuffer& buffer, const CommandBuffer::Command& command)
+    {
+        if (command.type == CommandBuffer::CommandType::Create)
+        {
+            buffer.m_created[command.target] = static_cast<entt::entity>(CreateEntity().GetId());
+            return;
+        }
+
+        const entt::entity entity =
+            command.deferred ? buffer.m_created[command.target] : static_cast<entt::entity>(command.target);
+        if (entity == entt::null || !m_registry.valid(entity))
+            return;
+
+        if (command.type == CommandBuffer::CommandType::Destroy)
+            DestroyEntity(static_cast<uint32_t>(entity));
+        else
+            command.apply(m_registry, entity, command.payload);
+    }
+
+    void EntityList::TransformHierarchy::OnChanged(entt::registry&, entt::entity)
+    {
+        changed = true;
+    }
+
+    void EntityList::TransformHierarchy::OnTransformUpdate(entt::registry& registry, entt::entity entity)
+    {
+        if (Hierarchy* hierarchy = registry.try_get<Hierarchy>(entity))
+        {
+            hierarchy->dirty = true;
+            if (PageTracker::Pool* hierarchyPages = pages ? pages->Find<Hierarchy>() : nullptr)
+                hierarchyPages->Mark(entity);
+        }
+    }
+
+    void EntityList::NameIndex::OnConstruct(entt::registry& registry, entt::entity entity)
+    {
+        // most entities keep the default empty name, which nothing looks up
+        const uint32_t name = registry.get<Name>(entity).id;
+        if (name == StringPool::EmptyId)
+            return;
+
+        std::vector<entt::entity>& named = entities[name];
+        names[entity] = Slot{name, static_cast<uint32_t>(named.size())};
+        named.push_back(entity);
+    }
+
+    void EntityList::NameIndex::OnUpdate(entt::registry& registry, entt::entity entity)
+    {
+        Erase(entity);
+        OnConstruct(registry, entity);
+    }
+
+    void EntityList::NameIndex::OnDestroy(entt::registry&, entt::entity entity)
+    {
+        Erase(entity);
+    }
+
+    void EntityList::NameIndex::Erase(entt::entity entity)
+    {
+        auto slot = names.find(entity);
+        if (slot == names.end())
+            return;
+
+        auto named = entities.find(slot->second.name);
+        std::vector<entt::entity>& list = named->second;
+
+        // move the last entity of the name into the gap so nothing has to be searched or shifted
+        const entt::entity last = list.back();
+        list[slot->second.position] = last;
+        names[last].position = slot->second.position;
+        list.pop_back();
+
+        if (list.empty())
+            entities.erase(named);
+
+        names.erase(slot);
+    }
+
 } // namespace Fenrir
\ No newline at end of file
@@ -0,0 +1,222 @@
+#include "FenrirECS/EntityListFork.hpp"
+
+#include "FenrirECS/EntityList.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+namespace Fenrir
+{
+    namespace
+    {
+        std::atomic<uint64_t> s_nextForkId = 1;
+
+        /**
+         * @brief Copy bytes into a new page
+         *
+         * @param bytes the bytes the page should hold
+         * @param size the number of bytes
+         * @param capacity the size of a full page
+         * @return std::shared_ptr<std::byte[]> the page
+         */
+        std::shared_ptr<std::byte[]> CopyPage(const std::byte* bytes, size_t size, size_t capacity)
+        {
+            // allocated with new[] rather than make_shared so the page is aligned for any component
+            std::shared_ptr<std::byte[]> page(new std::byte[capacity]);
+            std::memcpy(page.get(), bytes, size);
+            return page;
+        }
+    } // namespace
+
+    EntityListFork EntityListFork::Create(EntityList& entityList, const EntityListFork* base,
+                                          const SnapshotSchema& schema)
+    {
+        entt::registry& registry = entityList.m_registry;
+        PageTracker& pages = entityList.GetPageTracker();
+
+        EntityListFork fork;
+        fork.m_id = s_nextForkId.fetch_add(1, std::memory_order_relaxed);
+
+        const uint64_t baseId = base ? base->m_id : 0;
+        fork.Capture(fork.m_living, pages.GetLiving(), base ? &base->m_living : nullptr, baseId, nullptr, registry);
+
+        for (const SnapshotSchema::Column& column : schema.m_columns)
+        {
+            const size_t perPage = std::max<size_t>(PageSize / column.memorySize, 1);
+            PageTracker::Pool& pool = column.track(registry, pages, perPage);
+
+            ColumnState state;
+            state.id = column.id;
+            state.elementSize = column.memorySize;
+            fork.Capture(state, pool, base ? base->Find(column.id) : nullptr, baseId, &column, registry);
+
+            fork.m_columns.push_back(std::move(state));
+        }
+
+        return fork;
+    }
+
+    bool EntityListFork::Restore(EntityList& entityList, const SnapshotSchema& schema) const
+    {
+        entt::registry& registry = entityList.m_registry;
+        PageTracker& pages = entityList.GetPageTracker();
+        bool inPlace = true;
+
+        // put back the living entities first, destroying the new ones takes their components out of the pools too
+        PageTracker::Pool& living = pages.GetLiving();
+        if (!MatchesEntities(m_living, living))
+        {
+            inPlace = false;
+
+            std::vector<entt::entity> forked;
+            forked.reserve(m_living.count);
+            for (size_t first = 0, page = 0; first < m_living.count; first += m_living.perPage, ++page)
+            {
+                const auto* pageEntities = reinterpret_cast<const entt::entity*>(m_living.entityPages[page].get());
+                const size_t count = std::min(m_living.perPage, m_living.count - first);
+                forked.insert(forked.end(), pageEntities, pageEntities + count);
+            }
+
+            entt::sparse_set forkedSet;
+            forkedSet.push(forked.begin(), forked.end());
+
+            std::vector<entt::entity> created;
+            for (const entt::entity entity : living.GetEntities())
+            {
+                if (!forkedSet.contains(entity))
+                    created.push_back(entity);
+            }
+            entityList.DestroyEntities(created.begin(), created.end());
+
+            for (const entt::entity entity : forked)
+            {
+                if (!registry.valid(entity))
+                    registry.create(entity);
+            }
+
+            pages.SetLiving(forked.data(), forked.size());
+        }
+        living.Reset(m_id);
+
+        for (const ColumnState& state : m_columns)
+        {
+            const SnapshotSchema::Column* column = schema.Find(state.id);
+            if (!column || column->memorySize != state.elementSize)
+                continue;
+
+            PageTracker::Pool& pool = column->track(registry, pages, state.perPage);
+            if (MatchesEntities(state, pool))
+            {
+                for (size_t first = 0, page = 0; first < state.count; first += state.perPage, ++page)
+                {
+                    if (!MayDiffer(pool, page))
+                        continue;
+
+                    column->restore(registry, reinterpret_cast<const entt::entity*>(state.entityPages[page].get()),
+                                    std::min(state.perPage, state.count - first), state.componentPages[page].get());
+                }
+            }
+            else
+            {
+                // entities joined, left or moved within the pool, so only this pool is built again
+                inPlace = false;
+                column->clear(registry);
+
+                for (size_t first = 0, page = 0; first < state.count; first += state.perPage, ++page)
+                {
+                    column->insert(registry, reinterpret_cast<const entt::entity*>(state.entityPages[page].get()),
+                                   std::min(state.perPage, state.count - first), state.componentPages[page].get());
+                }
+            }
+
+            pool.Reset(m_id);
+        }
+
+        return inPlace;
+    }
+
+    size_t EntityListFork::GetPageCount() const
+    {
+        size_t count = m_living.entityPages.size();
+        for (const ColumnState& state : m_columns)
+            count += state.entityPages.size() + state.componentPages.size();
+
+        return count;
+    }
+
+    size_t EntityListFork::GetCopiedPageCount() const
+    {
+        return m_copiedPages;
+    }
+
+    const EntityListFork::ColumnState* EntityListFork::Find(uint64_t id) const
+    {
+        auto it = std::find_if(m_columns.begin(), m_columns.end(), [id](const ColumnState& s) { return s.id == id; });
+        return it != m_columns.end() ? &*it : nullptr;
+    }
+
+    void EntityListFork::Capture(ColumnState& state, PageTracker::Pool& pool, const ColumnState* base, uint64_t baseId,
+                                 const SnapshotSchema::Column* column, entt::registry& registry)
+    {
+        const entt::sparse_set& entities = pool.GetEntities();
+        state.count = entities.size();
+        state.perPage = pool.GetPerPage();
+
+        // the pool's marks only say what changed since the fork it was last forked or restored from
+        if (base && (baseId != pool.GetFork() || base->perPage != state.perPage ||
+                     base->elementSize != state.elementSize))
+            base = nullptr;
+
+        const size_t entityCapacity = state.perPage * sizeof(entt::entity);
+        const size_t componentCapacity = state.perPage * state.elementSize;
+
+        for (size_t first = 0, page = 0; first < state.count; first += state.perPage, ++page)
+        {
+            if (base && page < base->entityPages.size() && !pool.IsDirty(page))
+            {
+                state.entityPages.push_back(base->entityPages[page]);
+                if (column)
+                    state.componentPages.push_back(base->componentPages[page]);
+                continue;
+            }
+
+            const size_t count = std::min(state.perPage, state.count - first);
+            state.entityPages.push_back(CopyPage(reinterpret_cast<const std::byte*>(entities.data() + first),
+                                                 count * sizeof(entt::entity), entityCapacity));
+            ++m_copiedPages;
+
+            if (column)
+            {
+                std::shared_ptr<std::byte[]> components(new std::byte[componentCapacity]);
+                column->gather(registry, entities.data() + first, count, components.get());
+                state.componentPages.push_back(std::move(components));
+                ++m_copiedPages;
+            }
+        }
+
+        pool.Reset(m_id);
+    }
+
+    bool EntityListFork::MayDiffer(const PageTracker::Pool& pool, size_t page) const
+    {
+        return pool.GetFork() != m_id || pool.IsDirty(page);
+    }
+
+    bool EntityListFork::MatchesEntities(const ColumnState& state, const PageTracker::Pool& pool) const
+    {
+        const entt::sparse_set& entities = pool.GetEntities();
+        if (entities.size() != state.count)
+            return false;
+
+        for (size_t first = 0, page = 0; first < state.count; first += state.perPage, ++page)
+        {
+            const size_t count = std::min(state.perPage, state.count - first);
+            if (MayDiffer(pool, page) &&
+                std::memcmp(state.entityPages[page].get(), entities.data() + first, count * sizeof(entt::entity)) != 0)
+                return false;
+        }
+
+        return true;
+    }
+} // namespace Fenrir
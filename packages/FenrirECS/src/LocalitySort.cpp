@@ -0,0 +1,14 @@
+#include "FenrirECS/LocalitySort.hpp"
+
+namespace Fenrir
+{
+    bool LocalitySort::IsPending() const
+    {
+        return m_stage != Stage::Idle || m_changes > 0;
+    }
+
+    void LocalitySort::OnChanged(entt::registry&, entt::entity)
+    {
+        ++m_changes;
+    }
+} // namespace Fenrir
@@ -0,0 +1,91 @@
+#include "FenrirECS/Observer.hpp"
+
+#include <cassert>
+
+namespace Fenrir
+{
+    size_t Observer::GetCount() const
+    {
+        return m_entities.size();
+    }
+
+    bool Observer::IsEmpty() const
+    {
+        return m_entities.empty();
+    }
+
+    bool Observer::Contains(uint32_t id) const
+    {
+        return m_slots.contains(static_cast<entt::entity>(id));
+    }
+
+    const std::vector<entt::entity>& Observer::GetEntities() const
+    {
+        return m_entities;
+    }
+
+    void Observer::Clear()
+    {
+        m_entities.clear();
+        m_slots.clear();
+    }
+
+    Observer::Recorder& Observer::AddRecorder(void (*disconnect)(entt::registry&, Recorder&))
+    {
+        assert(m_recorders.size() < MaxEvents && "an observer has one bit per event");
+
+        const uint32_t event = 1u << m_recorders.size();
+        m_recorders.push_back(std::make_unique<Recorder>(Recorder{this, event, disconnect}));
+        return *m_recorders.back();
+    }
+
+    void Observer::Record(entt::entity entity, uint32_t event)
+    {
+        auto [it, inserted] = m_slots.try_emplace(entity, Slot{static_cast<uint32_t>(m_entities.size()), 0});
+        if (inserted)
+            m_entities.push_back(entity);
+
+        it->second.events |= event;
+    }
+
+    void Observer::Forget(entt::entity entity, uint32_t event)
+    {
+        auto it = m_slots.find(entity);
+        if (it == m_slots.end())
+            return;
+
+        // the entity stays while any other event still has it recorded
+        it->second.events &= ~event;
+        if (it->second.events != 0)
+            return;
+
+        // fill the gap with the last entity so the entities stay packed
+        const uint32_t position = it->second.position;
+        m_slots.erase(it);
+        if (position != m_entities.size() - 1)
+        {
+            m_entities[position] = m_entities.back();
+            m_slots[m_entities[position]].position = position;
+        }
+
+        m_entities.pop_back();
+    }
+
+    void Observer::Disconnect(entt::registry& registry)
+    {
+        for (const auto& recorder : m_recorders)
+            recorder->disconnect(registry, *recorder);
+
+        m_recorders.clear();
+    }
+
+    void Observer::Recorder::OnRecord(entt::registry&, entt::entity entity)
+    {
+        observer->Record(entity, event);
+    }
+
+    void Observer::Recorder::OnForget(entt::registry&, entt::entity entity)
+    {
+        observer->Forget(entity, event);
+    }
+} // namespace Fenrir
@@ -0,0 +1,131 @@
+#include "FenrirECS/PageTracker.hpp"
+
+#include <algorithm>
+
+namespace Fenrir
+{
+    PageTracker::Pool::Pool(const entt::sparse_set& entities, size_t perPage)
+        : m_entities(&entities), m_perPage(perPage), m_fork(0), m_dirty(), m_pageCount(0)
+    {
+        Grow((entities.size() + perPage - 1) / perPage);
+    }
+
+    void PageTracker::Pool::Mark(entt::entity entity)
+    {
+        if (m_entities->contains(entity))
+            MarkPosition(m_entities->index(entity));
+    }
+
+    void PageTracker::Pool::MarkPosition(size_t position)
+    {
+        // positions past the last page already count as dirty, so the pages are never reallocated here
+        const size_t page = position / m_perPage;
+        if (page < m_pageCount)
+            m_dirty[page].store(true, std::memory_order_relaxed);
+    }
+
+    void PageTracker::Pool::MarkAll()
+    {
+        m_fork = 0;
+    }
+
+    bool PageTracker::Pool::IsDirty(size_t page) const
+    {
+        return page >= m_pageCount || m_dirty[page].load(std::memory_order_relaxed);
+    }
+
+    uint64_t PageTracker::Pool::GetFork() const
+    {
+        return m_fork;
+    }
+
+    void PageTracker::Pool::Reset(uint64_t fork)
+    {
+        const size_t pageCount = (m_entities->size() + m_perPage - 1) / m_perPage;
+        if (pageCount > m_pageCount)
+            Grow(pageCount);
+
+        for (size_t i = 0; i < m_pageCount; ++i)
+            m_dirty[i].store(false, std::memory_order_relaxed);
+
+        m_fork = fork;
+    }
+
+    void PageTracker::Pool::Grow(size_t pageCount)
+    {
+        // pages that were not tracked yet have to be treated as dirty
+        pageCount = std::max(pageCount, m_pageCount * 2);
+        auto dirty = std::make_unique<std::atomic<bool>[]>(pageCount);
+        for (size_t i = 0; i < pageCount; ++i)
+            dirty[i].store(i >= m_pageCount || m_dirty[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+        m_dirty = std::move(dirty);
+        m_pageCount = pageCount;
+    }
+
+    const entt::sparse_set& PageTracker::Pool::GetEntities() const
+    {
+        return *m_entities;
+    }
+
+    size_t PageTracker::Pool::GetPerPage() const
+    {
+        return m_perPage;
+    }
+
+    void PageTracker::Pool::OnConstruct(entt::registry&, entt::entity entity)
+    {
+        MarkPosition(m_entities->index(entity));
+    }
+
+    void PageTracker::Pool::OnUpdate(entt::registry&, entt::entity entity)
+    {
+        MarkPosition(m_entities->index(entity));
+    }
+
+    void PageTracker::Pool::OnDestroy(entt::registry&, entt::entity entity)
+    {
+        // the last entity is moved into the removed one's place
+        MarkPosition(m_entities->index(entity));
+        MarkPosition(m_entities->size() - 1);
+    }
+
+    // the living entities are paged the same as a pool of components the size of an entity
+    PageTracker::PageTracker() : m_living(), m_livingPages(m_living, 4096), m_pools()
+    {
+    }
+
+    PageTracker::Pool& PageTracker::GetLiving()
+    {
+        return m_livingPages;
+    }
+
+    void PageTracker::OnCreate(entt::entity entity)
+    {
+        m_living.push(entity);
+        m_livingPages.MarkPosition(m_living.size() - 1);
+    }
+
+    void PageTracker::OnDestroy(entt::entity entity)
+    {
+        if (!m_living.contains(entity))
+            return;
+
+        m_livingPages.MarkPosition(m_living.index(entity));
+        m_livingPages.MarkPosition(m_living.size() - 1);
+        m_living.erase(entity);
+    }
+
+    void PageTracker::ClearLiving()
+    {
+        m_living.clear();
+        m_livingPages.MarkAll();
+    }
+
+    void PageTracker::SetLiving(const entt::entity* entities, size_t count)
+    {
+        m_living.clear();
+        m_living.push(entities, entities + count);
+        m_livingPages.MarkAll();
+    }
+} // namespace Fenrir
@@ -0,0 +1,424 @@
+#include "FenrirECS/Snapshot.hpp"
+
+#include "FenrirECS/DefaultComponents.hpp"
+#include "FenrirECS/EntityList.hpp"
+
+#include <algorithm>
+#include <fstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Fenrir
+{
+    namespace
+    {
+        constexpr char Magic[4] = {'F', 'S', 'N', 'P'};
+
+        // every block starts on this boundary so raw columns can be used in place from the mapped file
+        constexpr size_t Alignment = 16;
+
+        struct FileHeader
+        {
+            char magic[4];
+            uint32_t version;
+            uint32_t entityCount;
+            uint32_t columnCount;
+        };
+
+        struct ColumnHeader
+        {
+            uint64_t id;
+            uint64_t dataSize;
+            uint32_t count;
+            uint32_t elementSize;
+            uint64_t reserved;
+        };
+
+        static_assert(sizeof(FileHeader) % Alignment == 0 && sizeof(ColumnHeader) % Alignment == 0);
+        static_assert(sizeof(entt::entity) == sizeof(uint32_t), "snapshots store entity ids as 32 bit values");
+
+        size_t AlignUp(size_t offset)
+        {
+            return (offset + Alignment - 1) & ~(Alignment - 1);
+        }
+
+        void WritePadding(std::ostream& out)
+        {
+            static constexpr char zeros[Alignment] = {};
+            const size_t offset = static_cast<size_t>(out.tellp());
+            out.write(zeros, static_cast<std::streamsize>(AlignUp(offset) - offset));
+        }
+
+        void WriteEntities(std::ostream& out, const std::vector<entt::entity>& entities)
+        {
+            out.write(reinterpret_cast<const char*>(entities.data()),
+                      static_cast<std::streamsize>(entities.size() * sizeof(entt::entity)));
+        }
+
+        /**
+         * @brief A read only view of a whole file mapped into memory
+         *
+         */
+        class MappedFile
+        {
+          public:
+            MappedFile() = default;
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            ~MappedFile()
+            {
+#ifdef _WIN32
+                if (m_data)
+                    UnmapViewOfFile(m_data);
+                if (m_mapping)
+                    CloseHandle(m_mapping);
+                if (m_file != INVALID_HANDLE_VALUE)
+                    CloseHandle(m_file);
+#else
+                if (m_data)
+                    munmap(const_cast<std::byte*>(m_data), m_size);
+#endif
+            }
+
+            bool Open(const std::string& path)
+            {
+#ifdef _WIN32
+                m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                     FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+                if (m_file == INVALID_HANDLE_VALUE)
+                    return false;
+
+                LARGE_INTEGER size;
+                if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+                    return false;
+
+                m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if (!m_mapping)
+                    return false;
+
+                m_data = static_cast<const std::byte*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+                m_size = static_cast<size_t>(size.QuadPart);
+#else
+                const int fd = open(path.c_str(), O_RDONLY);
+                if (fd < 0)
+                    return false;
+
+                struct stat info;
+                if (fstat(fd, &info) != 0 || info.st_size == 0)
+                {
+                    close(fd);
+                    return false;
+                }
+
+                m_size = static_cast<size_t>(info.st_size);
+                void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                close(fd);
+
+                if (data == MAP_FAILED)
+                    return false;
+
+                // the file is read front to back once, so let the kernel read ahead
+                madvise(data, m_size, MADV_SEQUENTIAL);
+                m_data = static_cast<const std::byte*>(data);
+#endif
+                return m_data != nullptr;
+            }
+
+            const std::byte* GetData() const
+            {
+                return m_data;
+            }
+
+            size_t GetSize() const
+            {
+                return m_size;
+            }
+
+          private:
+            const std::byte* m_data = nullptr;
+            size_t m_size = 0;
+#ifdef _WIN32
+            HANDLE m_file = INVALID_HANDLE_VALUE;
+            HANDLE m_mapping = nullptr;
+#endif
+        };
+
+        /**
+         * @brief Walks a mapped file, never reading past its end
+         *
+         */
+        struct Reader
+        {
+            const std::byte* data;
+            size_t size;
+            size_t offset = 0;
+
+            const std::byte* Take(size_t bytes)
+            {
+                if (bytes > size - offset)
+                    return nullptr;
+
+                const std::byte* result = data + offset;
+                offset += bytes;
+                return result;
+            }
+
+            template <typename T>
+            bool Read(T& value)
+            {
+                const std::byte* bytes = Take(sizeof(T));
+                if (!bytes)
+                    return false;
+
+                std::memcpy(&value, bytes, sizeof(T));
+                return true;
+            }
+
+            bool ReadEntities(uint32_t count, std::vector<entt::entity>& entities)
+            {
+                const std::byte* bytes = Take(static_cast<size_t>(count) * sizeof(entt::entity));
+                if (!bytes)
+                    return false;
+
+                entities.resize(count);
+                std::memcpy(entities.data(), bytes, entities.size() * sizeof(entt::entity));
+                return true;
+            }
+
+            void Align()
+            {
+                offset = std::min(AlignUp(offset), size);
+            }
+        };
+    } // namespace
+
+    SnapshotSchema& SnapshotSchema::Default()
+    {
+        static SnapshotSchema schema = [] {
+            SnapshotSchema defaults;
+            defaults.Register<Transform>("Transform")
+                .RegisterName("Name")
+                .Register<Hierarchy>("Hierarchy")
+                .Register<WorldTransform>("WorldTransform");
+            return defaults;
+        }();
+
+        return schema;
+    }
+
+    SnapshotSchema& SnapshotSchema::RegisterName(std::string_view name)
+    {
+        Column column;
+        column.id = HashName(name);
+        column.elementSize = 0;
+
+        column.collect = [](entt::registry& registry, std::vector<entt::entity>& entities) {
+            const auto& storage = registry.storage<Name>();
+            entities.assign(storage.data(), storage.data() + storage.size());
+        };
+
+        // each name is written as its length followed by its characters
+        column.write = [](entt::registry& registry, const std::vector<entt::entity>& entities, std::ostream& out) {
+            const auto& storage = registry.storage<Name>();
+            for (const entt::entity entity : entities)
+            {
+                const std::string_view str = storage.get(entity).Get();
+                const uint32_t length = static_cast<uint32_t>(str.size());
+                out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+                out.write(str.data(), static_cast<std::streamsize>(str.size()));
+            }
+        };
+
+        column.read = [](entt::registry& registry, const std::vector<entt::entity>& entities, const std::byte* data,
+                         size_t size) {
+            const auto& storage = registry.storage<Name>();
+            if (std::any_of(entities.begin(), entities.end(), [&](entt::entity e) { return storage.contains(e); }))
+                return false;
+
+            Reader reader{data, size};
+            std::vector<Name> names;
+            names.reserve(entities.size());
+
+            for (size_t i = 0; i < entities.size(); ++i)
+            {
+                uint32_t length;
+                if (!reader.Read(length))
+                    return false;
+
+                const std::byte* chars = reader.Take(length);
+                if (!chars)
+                    return false;
+
+                names.emplace_back(std::string_view(reinterpret_cast<const char*>(chars), length));
+            }
+
+            registry.insert<Name>(entities.begin(), entities.end(), names.begin());
+            return true;
+        };
+
+        // names are handles into the global string pool, so within the process they can be copied raw
+        SetMemoryFuncs<Name>(column);
+        m_columns.push_back(column);
+        return *this;
+    }
+
+    uint64_t SnapshotSchema::HashName(std::string_view name)
+    {
+        // FNV-1a, which is stable across compilers and platforms unlike std::hash
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (const char c : name)
+        {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 0x100000001b3ull;
+        }
+
+        return hash;
+    }
+
+    const SnapshotSchema::Column* SnapshotSchema::Find(uint64_t id) const
+    {
+        auto it = std::find_if(m_columns.begin(), m_columns.end(), [id](const Column& c) { return c.id == id; });
+        return it != m_columns.end() ? &*it : nullptr;
+    }
+
+    bool Snapshot::Save(EntityList& entityList, const std::string& path, const SnapshotSchema& schema)
+    {
+        entt::registry& registry = entityList.m_registry;
+
+        std::vector<std::vector<entt::entity>> columnEntities(schema.m_columns.size());
+        std::vector<entt::entity> entities;
+        uint32_t columnCount = 0;
+
+        for (size_t i = 0; i < schema.m_columns.size(); ++i)
+        {
+            schema.m_columns[i].collect(registry, columnEntities[i]);
+            if (columnEntities[i].empty())
+                continue;
+
+            entities.insert(entities.end(), columnEntities[i].begin(), columnEntities[i].end());
+            ++columnCount;
+        }
+
+        // in id order so loading hands out ids the same way the registry would have
+        std::sort(entities.begin(), entities.end());
+        entities.erase(std::unique(entities.begin(), entities.end()), entities.end());
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out)
+            return false;
+
+        FileHeader header = {};
+        std::memcpy(header.magic, Magic, sizeof(Magic));
+        header.version = Version;
+        header.entityCount = static_cast<uint32_t>(entities.size());
+        header.columnCount = columnCount;
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        WriteEntities(out, entities);
+        WritePadding(out);
+
+        for (size_t i = 0; i < schema.m_columns.size(); ++i)
+        {
+            const SnapshotSchema::Column& column = schema.m_columns[i];
+            if (columnEntities[i].empty())
+                continue;
+
+            ColumnHeader columnHeader = {};
+            columnHeader.id = column.id;
+            columnHeader.count = static_cast<uint32_t>(columnEntities[i].size());
+            columnHeader.elementSize = column.elementSize;
+
+            const std::streampos headerPos = out.tellp();
+            out.write(reinterpret_cast<const char*>(&columnHeader), sizeof(columnHeader));
+            WriteEntities(out, columnEntities[i]);
+            WritePadding(out);
+
+            const std::streampos dataBegin = out.tellp();
+            column.write(registry, columnEntities[i], out);
+            const std::streampos dataEnd = out.tellp();
+            WritePadding(out);
+
+            // the size of names is only known once they are written, so the header is filled in afterwards
+            columnHeader.dataSize = static_cast<uint64_t>(dataEnd - dataBegin);
+            const std::streampos blockEnd = out.tellp();
+            out.seekp(headerPos);
+            out.write(reinterpret_cast<const char*>(&columnHeader), sizeof(columnHeader));
+            out.seekp(blockEnd);
+        }
+
+        return out.good();
+    }
+
+    bool Snapshot::Load(EntityList& entityList, const std::string& path, const SnapshotSchema& schema)
+    {
+        entt::registry& registry = entityList.m_registry;
+        entityList.Clear();
+
+        MappedFile file;
+        if (!file.Open(path))
+            return false;
+
+        Reader reader{file.GetData(), file.GetSize()};
+
+        FileHeader header;
+        if (!reader.Read(header) || std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.version != Version)
+            return false;
+
+        std::vector<entt::entity> entities;
+        if (!reader.ReadEntities(header.entityCount, entities))
+            return false;
+        reader.Align();
+
+        for (const entt::entity entity : entities)
+        {
+            // a hint that is already taken means the file has duplicate ids
+            if (registry.create(entity) != entity)
+            {
+                entityList.Clear();
+                return false;
+            }
+            if (entityList.m_pages)
+                entityList.m_pages->OnCreate(entity);
+        }
+
+        for (uint32_t i = 0; i < header.columnCount; ++i)
+        {
+            ColumnHeader columnHeader;
+            if (!reader.Read(columnHeader) || !reader.ReadEntities(columnHeader.count, entities))
+            {
+                entityList.Clear();
+                return false;
+            }
+            reader.Align();
+
+            const std::byte* data = reader.Take(columnHeader.dataSize);
+            reader.Align();
+
+            const SnapshotSchema::Column* column = schema.Find(columnHeader.id);
+            if (!column)
+                continue;
+
+            const bool valid = data && column->elementSize == columnHeader.elementSize &&
+                               std::all_of(entities.begin(), entities.end(),
+                                           [&](entt::entity entity) { return registry.valid(entity); });
+
+            if (!valid || !column->read(registry, entities, data, columnHeader.dataSize))
+            {
+                entityList.Clear();
+                return false;
+            }
+        }
+
+        return true;
+    }
+} // namespace Fenrir
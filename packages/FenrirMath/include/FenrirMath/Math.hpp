@@ -335,6 +335,15 @@ namespace Fenrir::Math
         }
     };
 
+    /**
+     * @brief Represents an axis aligned box in 3D space defined by its minimum and maximum corners.
+     */
+    struct AABB
+    {
+        Point min; ///< The corner with the smallest coordinates.
+        Point max; ///< The corner with the largest coordinates.
+    };
+
     /**
      * @brief Creates a ray from two points. The first point is the origin and the second point helps determine the
      * direction.
@@ -2,10 +2,16 @@
 
 #include <string>
 
+#include "FenrirCore/Handle.hpp"
 #include "FenrirECS/EntityList.hpp"
+#include "FenrirECS/EntityListFork.hpp"
 
 namespace Fenrir
 {
+    class Scene;
+
+    using SceneHandle = Handle<Scene>;
+
     class Scene
     {
       public:
@@ -19,6 +25,22 @@ namespace Fenrir
 
         EntityList& GetEntityList();
 
+        /**
+         * @brief Fork the scene's entities so they can be restored later, forking from the last fork every tick only
+         * copies the pages that were written to since it
+         *
+         * @param base the last fork made from or restored to this scene to share unchanged pages with, or nullptr
+         * @return EntityListFork the fork
+         */
+        EntityListFork Fork(const EntityListFork* base = nullptr);
+
+        /**
+         * @brief Restore the scene's entities to a fork of this scene
+         *
+         * @param fork the fork to restore
+         */
+        void Restore(const EntityListFork& fork);
+
       private:
         std::string m_name;
 
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+#include "FenrirECS/CommandBuffer.hpp"
+#include "FenrirECS/EntityList.hpp"
+#include "FenrirScheduler/ThreadPool.hpp"
+
+namespace Fenrir
+{
+    /**
+     * @brief Builds a range of a streamed scene's entities into a command buffer, it is called from worker threads
+     * with different ranges at the same time so it must only read shared data
+     *
+     */
+    using SceneChunkFunc = std::function<void(CommandBuffer& commands, size_t first, size_t last)>;
+
+    /**
+     * @brief Loads entities into a live entity list without stalling the frame
+     * The entities are split into chunks that are built into command buffers on the thread pool, and the main thread
+     * plays the built chunks back in order under a time budget each frame. A stream must be owned by a shared_ptr so
+     * the chunks still being built keep it alive
+     *
+     */
+    class SceneStream : public std::enable_shared_from_this<SceneStream>
+    {
+      public:
+        /**
+         * @brief Construct a new Scene Stream object
+         *
+         * @param count the number of entities to build
+         * @param chunkSize the number of entities in each chunk, which is the most work committed at once
+         * @param build the function that builds each chunk
+         */
+        SceneStream(size_t count, size_t chunkSize, SceneChunkFunc build);
+
+        SceneStream(const SceneStream&) = delete;
+
+        SceneStream& operator=(const SceneStream&) = delete;
+
+        /**
+         * @brief Start building every chunk as background work on the thread pool, so a thread waiting on frame work
+         * never picks up a chunk build
+         *
+         * @param threadPool the thread pool to build on
+         */
+        void Start(ThreadPool& threadPool);
+
+        /**
+         * @brief Play back built chunks in order until the budget runs out or the next chunk is not built yet, must be
+         * called from the thread that owns the entity list
+         *
+         * @param entityList the entity list to load into
+         * @param budget the time budget in seconds, at least one chunk is committed if one is ready
+         * @return size_t the number of chunks that were committed
+         */
+        size_t Commit(EntityList& entityList, double budget);
+
+        /**
+         * @brief Get how much of the stream has been committed
+         *
+         * @return float the committed fraction from 0 to 1
+         */
+        float GetProgress() const;
+
+        /**
+         * @brief Check if every chunk has been committed
+         *
+         * @return true if the stream is done
+         */
+        bool IsFinished() const;
+
+        /**
+         * @brief Check if building any chunk threw, the commands of a failed chunk are dropped and the rest of the
+         * stream is still committed
+         *
+         * @return true if a chunk failed
+         */
+        bool HasFailed() const;
+
+      private:
+        struct Chunk
+        {
+            std::unique_ptr<CommandBuffer> commands;
+            bool failed = false;
+            std::atomic<bool> built = false;
+        };
+
+        size_t m_count;
+        size_t m_chunkSize;
+        SceneChunkFunc m_build;
+
+        size_t m_chunkCount;
+        std::unique_ptr<Chunk[]> m_chunks;
+
+        // the next chunk to commit, chunks are always committed in order so the result is the same every run
+        size_t m_nextChunk = 0;
+        bool m_failed = false;
+
+        /**
+         * @brief Build a chunk, called on a worker thread
+         *
+         * @param index the index of the chunk
+         */
+        void BuildChunk(size_t index);
+    };
+} // namespace Fenrir
@@ -25,4 +25,14 @@ namespace Fenrir
     {
         return m_entityList;
     }
+
+    EntityListFork Scene::Fork(const EntityListFork* base)
+    {
+        return EntityListFork::Create(m_entityList, base);
+    }
+
+    void Scene::Restore(const EntityListFork& fork)
+    {
+        fork.Restore(m_entityList);
+    }
 } // namespace Fenrir
\ No newline at end of file
@@ -0,0 +1,90 @@
+#include "FenrirScene/SceneStream.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+namespace Fenrir
+{
+    SceneStream::SceneStream(size_t count, size_t chunkSize, SceneChunkFunc build)
+        : m_count(count), m_chunkSize(std::max<size_t>(chunkSize, 1)), m_build(std::move(build)),
+          m_chunkCount((count + m_chunkSize - 1) / m_chunkSize), m_chunks(std::make_unique<Chunk[]>(m_chunkCount))
+    {
+    }
+
+    void SceneStream::Start(ThreadPool& threadPool)
+    {
+        std::shared_ptr<SceneStream> self = shared_from_this();
+        for (size_t i = 0; i < m_chunkCount; ++i)
+        {
+            threadPool.EnqueueBackground([self, i]() { self->BuildChunk(i); });
+        }
+    }
+
+    size_t SceneStream::Commit(EntityList& entityList, double budget)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        size_t committed = 0;
+        while (m_nextChunk < m_chunkCount)
+        {
+            const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (committed > 0 && elapsed >= budget)
+                break;
+
+            Chunk& chunk = m_chunks[m_nextChunk];
+            if (!chunk.built.load(std::memory_order_acquire))
+                break;
+
+            if (chunk.failed)
+                m_failed = true;
+            else
+                entityList.Playback(*chunk.commands);
+
+            // the buffer is not reused, so give its memory back straight away
+            chunk.commands.reset();
+            ++m_nextChunk;
+            ++committed;
+        }
+
+        return committed;
+    }
+
+    float SceneStream::GetProgress() const
+    {
+        if (m_chunkCount == 0)
+            return 1.0f;
+
+        return static_cast<float>(m_nextChunk) / static_cast<float>(m_chunkCount);
+    }
+
+    bool SceneStream::IsFinished() const
+    {
+        return m_nextChunk == m_chunkCount;
+    }
+
+    bool SceneStream::HasFailed() const
+    {
+        return m_failed;
+    }
+
+    void SceneStream::BuildChunk(size_t index)
+    {
+        Chunk& chunk = m_chunks[index];
+        const size_t first = index * m_chunkSize;
+        const size_t last = std::min(first + m_chunkSize, m_count);
+
+        chunk.commands = std::make_unique<CommandBuffer>();
+        try
+        {
+            m_build(*chunk.commands, first, last);
+        }
+        catch (...)
+        {
+            chunk.commands.reset();
+            chunk.failed = true;
+        }
+
+        chunk.built.store(true, std::memory_order_release);
+    }
+} // namespace Fenrir
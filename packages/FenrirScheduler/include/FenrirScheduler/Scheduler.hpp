@@ -1,9 +1,14 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <functional>
 #include <initializer_list>
-#include <map>
+#include <typeindex>
+#include <vector>
 
+#include "TaskContext.hpp"
+#include "TaskOrder.hpp"
 #include "ThreadPool.hpp"
 
 namespace Fenrir
@@ -32,6 +37,71 @@ namespace Fenrir
         Exit
     };
 
+    /**
+     * @brief the number of schedule priorities, used to size arrays indexed by priority
+     *
+     */
+    constexpr size_t SchedulePriorityCount = static_cast<size_t>(SchedulePriority::Exit) + 1;
+
+    /**
+     * @brief The component types a system reads and writes
+     * Two systems conflict when one of them writes a type that the other reads or writes, conflicting systems in the
+     * same priority run in the order they were added while everything else runs in parallel. Systems added without
+     * an access are undeclared, they run in parallel with each other like they did before access could be declared,
+     * and conflict with every declared system since nothing is known about what they touch
+     *
+     */
+    class SystemAccess
+    {
+      public:
+        /**
+         * @brief Declare component types that the system reads
+         *
+         * @tparam T the component types
+         * @return SystemAccess& the access
+         */
+        template <typename... T>
+        SystemAccess& Reads();
+
+        /**
+         * @brief Declare component types that the system writes
+         *
+         * @tparam T the component types
+         * @return SystemAccess& the access
+         */
+        template <typename... T>
+        SystemAccess& Writes();
+
+        /**
+         * @brief Declare that the system may write anything, so it conflicts with every other system
+         *
+         * @return SystemAccess& the access
+         */
+        SystemAccess& WritesAll();
+
+        /**
+         * @brief Get the access of a system added without one
+         *
+         * @return SystemAccess the undeclared access
+         */
+        static SystemAccess Undeclared();
+
+        /**
+         * @brief Check if running alongside another system could cause a data race
+         *
+         * @param other the access of the other system
+         * @return true if either system writes a type the other one touches or writes everything, or only one of
+         * them is undeclared
+         */
+        bool ConflictsWith(const SystemAccess& other) const;
+
+      private:
+        std::vector<std::type_index> m_reads;
+        std::vector<std::type_index> m_writes;
+        bool m_writesAll = false;
+        bool m_undeclared = false;
+    };
+
     class Scheduler
     {
       public:
@@ -43,16 +113,150 @@ namespace Fenrir
         Scheduler& AddSystem(SchedulePriority priority, SystemFunc system);
         Scheduler& AddSequentialSystem(SchedulePriority priority, SystemFunc system);
 
+        /**
+         * @brief Add a system with declared component access, it runs in parallel with every system it does not
+         * conflict with and after every earlier system it does
+         *
+         * @param priority the priority of the system
+         * @param system the system function
+         * @param access the component types the system reads and writes
+         * @return Scheduler& the scheduler
+         */
+        Scheduler& AddSystem(SchedulePriority priority, SystemFunc system, SystemAccess access);
+
         void Init(App& app);
+
+        /**
+         * @brief Run every system of a priority, batches in parallel on the thread pool and then the sequential systems
+         * The systems are keyed in the calling thread's current TaskOrder run, which moves on to the next run after
+         *
+         * @param app the app to pass to the systems
+         * @param priority the priority of the systems to run
+         */
         void RunSystems(App& app, SchedulePriority priority);
 
+        /**
+         * @brief Run every system of a priority on the calling thread, in batch order and then the sequential systems
+         * Several threads can run the same priority at once this way, as long as each runs against different data. The
+         * plan must be finalized first since this never compiles it. Like RunSystems, this moves the calling thread on
+         * to its next TaskOrder run
+         *
+         * @param app the app to pass to the systems
+         * @param priority the priority of the systems to run
+         */
+        void RunSystemsInline(App& app, SchedulePriority priority);
+
+        /**
+         * @brief Check if the execution plan is up to date with every added system
+         *
+         * @return true if no systems have been added since the last Finalize
+         */
+        bool IsFinalized() const;
+
+        /**
+         * @brief Compile every registered system into a flat execution plan
+         * This is called automatically by RunSystems after systems have been added, calling it up front keeps the
+         * cost out of the first frame
+         *
+         */
+        void Finalize();
+
+        /**
+         * @brief Get the thread pool that parallel systems are run on
+         *
+         * @return ThreadPool& the thread pool
+         */
+        ThreadPool& GetThreadPool();
+
+        /**
+         * @brief Get the thread pool that parallel systems are run on
+         *
+         * @return const ThreadPool& the thread pool
+         */
+        const ThreadPool& GetThreadPool() const;
+
       private:
-        std::map<SchedulePriority, std::vector<SystemFunc>> m_runOnceSystems;
-        std::map<SchedulePriority, std::vector<SystemFunc>> m_systems;
-        std::map<SchedulePriority, std::vector<SystemFunc>> m_sequentialSystems;
+        struct System
+        {
+            SystemFunc func;
+            SystemAccess access;
+        };
+
+        /**
+         * @brief a range of systems in the execution plan that can all run at the same time
+         *
+         */
+        struct Batch
+        {
+            uint32_t begin;
+            uint32_t end;
+        };
+
+        /**
+         * @brief the ranges of the execution plan that belong to a single priority
+         *
+         */
+        struct Phase
+        {
+            uint32_t batchBegin = 0;
+            uint32_t batchEnd = 0;
+            uint32_t sequentialBegin = 0;
+            uint32_t sequentialEnd = 0;
+        };
+
+        /**
+         * @brief every non run once system flattened into contiguous arrays, so running a priority is an array index
+         * followed by a linear walk over its batches
+         *
+         */
+        struct ExecutionPlan
+        {
+            std::array<Phase, SchedulePriorityCount> phases;
+            std::vector<SystemFunc> parallelSystems; // ordered by priority then by batch
+            std::vector<Batch> batches;
+            std::vector<SystemFunc> sequentialSystems; // ordered by priority then by insertion
+            std::array<TaskCounter, SchedulePriorityCount> counters;
+        };
+
+        std::array<std::vector<SystemFunc>, SchedulePriorityCount> m_runOnceSystems;
+        std::array<std::vector<System>, SchedulePriorityCount> m_systems;
+        std::array<std::vector<SystemFunc>, SchedulePriorityCount> m_sequentialSystems;
+        ExecutionPlan m_plan;
+        bool m_planDirty = false;
         ThreadPool m_threadPool;
 
         bool IsRunOnceSystem(SchedulePriority priority);
-        void RunSequentialSystems(App& app, SchedulePriority priority);
+
+        /**
+         * @brief Run the sequential systems of a phase on the calling thread
+         *
+         * @param app the app to pass to the systems
+         * @param phase the phase to run
+         */
+        void RunSequentialSystems(App& app, const Phase& phase);
+
+        /**
+         * @brief Order a priority's systems into batches from their declared access
+         * A system's batch is one past the latest batch of any earlier system it conflicts with, which is the longest
+         * path to it in the dependency graph where conflicting systems are ordered by insertion
+         *
+         * @param systems the systems of a single priority
+         * @param phase the phase to fill in
+         */
+        void CompileBatches(const std::vector<System>& systems, Phase& phase);
     };
-} // namespace Fenrir
\ No newline at end of file
+
+    template <typename... T>
+    SystemAccess& SystemAccess::Reads()
+    {
+        (m_reads.emplace_back(typeid(T)), ...);
+        return *this;
+    }
+
+    template <typename... T>
+    SystemAccess& SystemAccess::Writes()
+    {
+        (m_writes.emplace_back(typeid(T)), ...);
+        return *this;
+    }
+} // namespace Fenrir
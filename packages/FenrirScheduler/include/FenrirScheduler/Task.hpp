@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Fenrir
+{
+    /**
+     * @brief A move only, type erased callable that stores its function object inline
+     * Unlike std::function a Task never allocates, the function object must fit inside Capacity bytes and this is
+     * checked at compile time
+     *
+     */
+    class Task
+    {
+      public:
+        /**
+         * @brief the maximum size in bytes of a function object stored in a task
+         *
+         */
+        static constexpr size_t Capacity = 56;
+
+        /**
+         * @brief Construct an empty Task object
+         *
+         */
+        Task() = default;
+
+        /**
+         * @brief Construct a new Task object from a function object
+         *
+         * @tparam F the function object type, must be invocable with no arguments
+         * @param func the function object to store
+         */
+        template <typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Task>>>
+        Task(F&& func);
+
+        Task(Task&& other) noexcept;
+
+        Task& operator=(Task&& other) noexcept;
+
+        Task(const Task&) = delete;
+
+        Task& operator=(const Task&) = delete;
+
+        /**
+         * @brief Destroy the Task object and the function object it holds
+         *
+         */
+        ~Task();
+
+        /**
+         * @brief Invoke the stored function object
+         *
+         */
+        void operator()();
+
+        /**
+         * @brief Check if the task holds a function object
+         *
+         * @return true if the task holds a function object
+         */
+        explicit operator bool() const;
+
+      private:
+        using InvokeFn = void (*)(void* storage);
+        using MoveFn = void (*)(void* dst, void* src); // move constructs into dst and destroys src
+        using DestroyFn = void (*)(void* storage);
+
+        alignas(std::max_align_t) std::byte m_storage[Capacity];
+
+        InvokeFn m_invoke = nullptr;
+        MoveFn m_move = nullptr;
+        DestroyFn m_destroy = nullptr;
+
+        /**
+         * @brief Destroy the held function object and leave the task empty
+         *
+         */
+        void Reset();
+    };
+
+    template <typename F, typename>
+    Task::Task(F&& func)
+    {
+        using Func = std::decay_t<F>;
+
+        static_assert(sizeof(Func) <= Capacity, "function object is too large to be stored in a Task");
+        static_assert(alignof(Func) <= alignof(std::max_align_t), "function object is over-aligned for a Task");
+        static_assert(std::is_nothrow_move_constructible_v<Func>, "function object must be nothrow move constructible");
+
+        ::new (static_cast<void*>(m_storage)) Func(std::forward<F>(func));
+
+        m_invoke = [](void* storage) { (*std::launder(static_cast<Func*>(storage)))(); };
+        m_move = [](void* dst, void* src) {
+            Func* source = std::launder(static_cast<Func*>(src));
+            ::new (dst) Func(std::move(*source));
+            source->~Func();
+        };
+        m_destroy = [](void* storage) { std::launder(static_cast<Func*>(storage))->~Func(); };
+    }
+} // namespace Fenrir
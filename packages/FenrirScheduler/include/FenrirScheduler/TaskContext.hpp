@@ -0,0 +1,51 @@
+#pragma once
+
+namespace Fenrir
+{
+    /**
+     * @brief A thread local pointer to whatever the calling thread's scheduled work is running against, such as the
+     * scene the app is running systems for. Work dispatched by the scheduler or split off with
+     * EntityList::ParallelFor carries the context of the work that dispatched it, the same way as the TaskOrder key,
+     * so it is the same no matter which thread ends up running the work. Work outside of the scheduler has no context
+     *
+     */
+    class TaskContext
+    {
+      public:
+        /**
+         * @brief Sets the context of the calling thread for the lifetime of the scope, restoring the previous context
+         * after
+         *
+         */
+        class Scope
+        {
+          public:
+            /**
+             * @brief Construct a new Scope object
+             *
+             * @param context the context of the work about to run, can be null
+             */
+            Scope(void* context);
+
+            /**
+             * @brief Destroy the Scope object and restore the previous context
+             *
+             */
+            ~Scope();
+
+            Scope(const Scope&) = delete;
+
+            Scope& operator=(const Scope&) = delete;
+
+          private:
+            void* m_previous;
+        };
+
+        /**
+         * @brief Get the context of the calling thread
+         *
+         * @return void* the context, null when none has been set
+         */
+        static void* Current();
+    };
+} // namespace Fenrir
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+
+namespace Fenrir
+{
+    /**
+     * @brief A latch style completion counter for a group of tasks
+     * The counter is raised when tasks are dispatched and lowered as they finish, so waiting on a whole group of tasks
+     * needs no futures or heap allocations. A counter can be reused once it has reached zero
+     *
+     */
+    class TaskCounter
+    {
+      public:
+        /**
+         * @brief Construct a new Task Counter object with a count of zero
+         *
+         */
+        TaskCounter() = default;
+
+        TaskCounter(const TaskCounter&) = delete;
+
+        TaskCounter& operator=(const TaskCounter&) = delete;
+
+        /**
+         * @brief Add outstanding tasks to the counter
+         *
+         * @param count the number of tasks to add
+         */
+        void Add(uint32_t count = 1);
+
+        /**
+         * @brief Mark a single task as finished
+         * Nothing touches the counter after the count is lowered, so a waiter may destroy it as soon as it sees zero
+         *
+         */
+        void Done();
+
+        /**
+         * @brief Record an exception thrown by one of the tasks, only the first exception is kept
+         * Must be called before Done for the failing task so the waiter is guaranteed to see it
+         *
+         * @param exception the exception that was thrown
+         */
+        void Fail(std::exception_ptr exception);
+
+        /**
+         * @brief Rethrow the exception recorded by a failed task, if any, and clear it so the counter can be reused
+         * Only call this once the counter is done
+         *
+         */
+        void Rethrow();
+
+        /**
+         * @brief Check if every task has finished
+         *
+         * @return true if the count is zero
+         */
+        bool IsDone() const;
+
+        /**
+         * @brief Block the calling thread until every task has finished, rethrowing the first exception a task threw
+         * Prefer ThreadPool::Wait when calling from a worker, as it runs other tasks while waiting
+         *
+         */
+        void Wait();
+
+      private:
+        std::atomic<uint32_t> m_count = 0;
+
+        std::atomic<bool> m_failed = false;
+
+        // only written by the first failing task and only read once the count has reached zero
+        std::exception_ptr m_exception;
+    };
+} // namespace Fenrir
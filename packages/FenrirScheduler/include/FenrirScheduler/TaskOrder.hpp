@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Fenrir
+{
+    /**
+     * @brief A thread local key for the piece of scheduled work the calling thread is running
+     * The scheduler gives every system a key from its position in the execution plan and work split off a system, such
+     * as ParallelForEach chunks, extends that key with its chunk index. Anything recorded from parallel work can be
+     * sorted by this key to get the same order every run, no matter which thread did the work. Work outside of the
+     * scheduler has a key of zero apart from its run
+     * The same systems run several times a frame, once per tick and once per scene, so every key also holds the run it
+     * belongs to in its top bits. Each thread has a current run that the systems it starts are keyed in, and running
+     * a phase moves the thread on to the next run, so anything recorded in a frame sorts in the order it happened
+     *
+     */
+    class TaskOrder
+    {
+      public:
+        /**
+         * @brief Sets the key of the calling thread for the lifetime of the scope, restoring the previous key after
+         *
+         */
+        class Scope
+        {
+          public:
+            /**
+             * @brief Construct a new Scope object
+             *
+             * @param key the key of the work about to run
+             */
+            Scope(uint64_t key);
+
+            /**
+             * @brief Destroy the Scope object and restore the previous key
+             *
+             */
+            ~Scope();
+
+            Scope(const Scope&) = delete;
+
+            Scope& operator=(const Scope&) = delete;
+
+          private:
+            uint64_t m_previousBase;
+            uint32_t m_previousSegment;
+        };
+
+        /**
+         * @brief the keys of a group of chunks split off from the calling work
+         *
+         */
+        struct ChunkKeys
+        {
+            uint64_t first;
+            uint64_t step;
+
+            /**
+             * @brief Get the key of a chunk
+             *
+             * @param chunkIndex the index of the chunk in the split
+             * @return uint64_t the key
+             */
+            uint64_t Get(uint32_t chunkIndex) const;
+        };
+
+        /**
+         * @brief Get the key of the calling thread
+         *
+         * @return uint64_t the key, zero when not running scheduled work
+         */
+        static uint64_t Current();
+
+        /**
+         * @brief the number of runs a key has room for, the app starts counting again from zero every frame
+         *
+         */
+        static constexpr uint32_t MaxRuns = 1u << 16;
+
+        /**
+         * @brief Get the key of a system from its index in the execution plan, in the current run of the calling
+         * thread
+         *
+         * @param systemIndex the index of the system
+         * @return uint64_t the key
+         */
+        static uint64_t ForSystem(uint32_t systemIndex);
+
+        /**
+         * @brief Get the key of a run, used to start work on another thread in a run of its own
+         *
+         * @param run the run
+         * @return uint64_t the key
+         */
+        static uint64_t ForRun(uint32_t run);
+
+        /**
+         * @brief Get the current run of the calling thread
+         *
+         * @return uint32_t the run
+         */
+        static uint32_t GetRun();
+
+        /**
+         * @brief Set the current run of the calling thread, a scope restores the run it was created in
+         *
+         * @param run the run, must be less than MaxRuns
+         * @throws std::overflow_error if the run does not fit in the key
+         */
+        static void SetRun(uint32_t run);
+
+        /**
+         * @brief Get the number of chunks the calling work can still be split into
+         * Each nesting level of split work has its own bits in the key so nested chunks never share a key with their
+         * siblings, once those bits are used up the work can not be split any further and has to run on one thread
+         *
+         * @return uint32_t the maximum number of chunks, zero if the work can not be split
+         */
+        static uint32_t GetMaxChunks();
+
+        /**
+         * @brief Reserve keys for chunks split off from the calling work
+         * The chunks sort after anything the work has recorded so far, and anything it records after the split sorts
+         * after the chunks, so several splits made by the same work keep the order they were made in
+         *
+         * @param chunkCount the number of chunks, must be at most GetMaxChunks()
+         * @return ChunkKeys the keys of the chunks
+         */
+        static ChunkKeys Split(uint32_t chunkCount);
+    };
+} // namespace Fenrir
@@ -1,33 +1,49 @@
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <functional>
 #include <future>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <stdexcept>
 #include <thread>
 #include <type_traits>
+#include <vector>
+
+#include "Task.hpp"
+#include "TaskCounter.hpp"
 
 namespace Fenrir
 {
     /**
-     * @brief A thread pool class that can be used to run functions on multiple threads
-     * @author Threadpool class comes from: https://github.com/progschj/ThreadPool
+     * @brief A work-stealing thread pool that can be used to run functions on multiple threads
+     * Every worker owns its own deque of tasks. A worker pushes and pops its own tasks from the back (LIFO), and when
+     * it runs out of work it steals from the front (FIFO) of another worker's deque, so the only shared lock is the
+     * one used to park idle workers
+     * @author Originally based on the ThreadPool class from: https://github.com/progschj/ThreadPool
      *
      */
     class ThreadPool
     {
       public:
+        /**
+         * @brief the number of tasks each worker deque can hold before tasks spill to other workers, and once every
+         * deque is full to a shared overflow queue
+         *
+         */
+        static constexpr size_t QueueCapacity = 1024;
+
         /**
          * @brief Construct a new Thread Pool object
          *
-         * @param threads The number of threads to create
+         * @param threads The number of threads to create (at least one thread is always created)
          */
         ThreadPool(size_t threads);
 
         /**
-         * @brief Destroy the Thread Pool object
+         * @brief Destroy the Thread Pool object, any queued tasks are finished before the workers exit
          *
          */
         ~ThreadPool();
@@ -44,16 +60,179 @@ namespace Fenrir
         template <class F, class... Args>
         auto Enqueue(F&& f, Args&&... args) -> std::future<typename std::invoke_result<F, Args...>::type>;
 
+        /**
+         * @brief Enqueue a long running function, such as streaming, to be run in the background
+         * Background work has a queue of its own that workers only take from when they have nothing else to do, it is
+         * never run by Wait so a thread waiting on frame work is not held up by it, and at most GetThreadCount() - 1
+         * workers run it at once so one is always free for frame work
+         *
+         * @tparam F the function type
+         * @tparam Args the arguments to the function
+         * @param f the function to run
+         * @param args the arguments to the function
+         * @return auto the return type of the function
+         */
+        template <class F, class... Args>
+        auto EnqueueBackground(F&& f, Args&&... args) -> std::future<typename std::invoke_result<F, Args...>::type>;
+
+        /**
+         * @brief Dispatch a task to be run on a thread without allocating
+         * The counter is raised before the task is queued and lowered once it has run. If every deque is full the task
+         * goes to an overflow queue that workers and Wait take from once the deques are empty, which is the only case
+         * that allocates. The task is never run on the calling thread, which may hold a lock the task needs
+         *
+         * @param task the task to run
+         * @param counter the counter to signal when the task has finished
+         */
+        void Dispatch(Task task, TaskCounter& counter);
+
+        /**
+         * @brief Wait for a counter to reach zero, running queued tasks on the calling thread while waiting
+         * This is safe to call from inside a task, as the waiting worker keeps making progress on other work. If any
+         * task signalling the counter threw, the first exception is rethrown here once every task has finished
+         *
+         * @param counter the counter to wait on
+         */
+        void Wait(TaskCounter& counter);
+
+        /**
+         * @brief Get the number of worker threads in the pool
+         *
+         * @return size_t the number of worker threads
+         */
+        size_t GetThreadCount() const;
+
+        /**
+         * @brief Get the index of the worker that is calling this function
+         * This can be used to index per thread data sized to GetThreadCount() + 1
+         *
+         * @return size_t the index of the calling worker, or GetThreadCount() when called from outside the pool
+         */
+        size_t GetCurrentWorkerIndex() const;
+
       private:
+        /**
+         * @brief a queued task and the counter to signal once it has run
+         *
+         */
+        struct QueueSlot
+        {
+            Task task;
+            TaskCounter* counter = nullptr;
+        };
+
+        /**
+         * @brief a fixed capacity ring buffer of tasks owned by a single worker, other workers only touch it when
+         * stealing
+         *
+         */
+        struct WorkerQueue
+        {
+            std::vector<QueueSlot> slots;
+            size_t head = 0; // the oldest task, which is where thieves take from
+            size_t size = 0;
+            std::mutex mutex;
+        };
+
         std::vector<std::thread> m_workers;
 
-        std::queue<std::function<void()>> m_tasks;
+        std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+
+        // number of tasks that have been pushed but not yet popped by a worker
+        std::atomic<size_t> m_pending;
+
+        // number of workers currently parked on m_condition
+        std::atomic<size_t> m_sleeping;
+
+        // tasks pushed while every deque was full, taken after the deques by anything that steals
+        std::deque<QueueSlot> m_overflow;
+
+        std::mutex m_overflowMutex;
+
+        // number of tasks in m_overflow, read without the lock to decide whether to look
+        std::atomic<size_t> m_overflowPending;
+
+        // round robin index used when a thread outside of the pool pushes a task
+        std::atomic<size_t> m_nextQueue;
+
+        // background work, which is never stolen by Wait
+        std::deque<Task> m_background;
+
+        std::mutex m_backgroundMutex;
+
+        // number of tasks in m_background, read without the lock to decide whether to look
+        std::atomic<size_t> m_backgroundPending;
 
-        std::mutex m_queueMutex;
+        // number of workers currently running background work, only changed while holding m_backgroundMutex
+        std::atomic<size_t> m_backgroundRunning;
+
+        std::mutex m_sleepMutex;
 
         std::condition_variable m_condition;
 
-        bool m_stop;
+        std::atomic<bool> m_stop;
+
+        /**
+         * @brief Push a task onto the calling worker's deque, or onto a round robin deque when called from outside the
+         * pool
+         *
+         * @param task the task to push
+         * @param counter the counter to signal once the task has run, can be null
+         */
+        void Push(Task task, TaskCounter* counter);
+
+        /**
+         * @brief Queue a task as background work
+         *
+         * @param task the task to queue
+         */
+        void PushBackground(Task task);
+
+        /**
+         * @brief Check if there is background work and few enough workers are already running background work
+         *
+         * @return true if a worker may take background work
+         */
+        bool CanRunBackground() const;
+
+        /**
+         * @brief Run one background task if there is one and few enough workers are already running background work
+         *
+         * @return true if a task was run
+         */
+        bool TryRunBackground();
+
+        /**
+         * @brief Pop a task from the back of a worker's own deque
+         *
+         * @param index the index of the worker
+         * @param slot the popped task
+         * @return true if a task was popped
+         */
+        bool TryPop(size_t index, QueueSlot& slot);
+
+        /**
+         * @brief Steal a task from the front of another worker's deque, or from the overflow queue once they are empty
+         *
+         * @param index the index of the worker that is stealing, or the number of workers for outside threads
+         * @param slot the stolen task
+         * @return true if a task was stolen
+         */
+        bool TrySteal(size_t index, QueueSlot& slot);
+
+        /**
+         * @brief Run a task and signal its counter, an exception thrown by the task is recorded on the counter
+         *
+         * @param slot the task to run
+         */
+        static void Run(QueueSlot& slot);
+
+        /**
+         * @brief The loop that each worker thread runs until the pool is stopped
+         *
+         * @param index the index of the worker
+         */
+        void WorkerLoop(size_t index);
     };
 
     template <class F, class... Args>
@@ -61,20 +240,36 @@ namespace Fenrir
     {
         using return_type = typename std::invoke_result<F, Args...>::type;
 
+        if (m_stop.load())
+            throw std::runtime_error("enqueue on stopped ThreadPool");
+
+        auto task = std::make_shared<std::packaged_task<return_type()>>(
+            std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+
+        std::future<return_type> res = task->get_future();
+
+        Push(Task([task]() { (*task)(); }), nullptr);
+
+        return res;
+    }
+
+    template <class F, class... Args>
+    auto ThreadPool::EnqueueBackground(F&& f, Args&&... args)
+        -> std::future<typename std::invoke_result<F, Args...>::type>
+    {
+        using return_type = typename std::invoke_result<F, Args...>::type;
+
+        if (m_stop.load())
+            throw std::runtime_error("enqueue on stopped ThreadPool");
+
         auto task = std::make_shared<std::packaged_task<return_type()>>(
             std::bind(std::forward<F>(f), std::forward<Args>(args)...));
 
         std::future<return_type> res = task->get_future();
-        {
-            std::unique_lock<std::mutex> lock(m_queueMutex);
 
-            if (m_stop)
-                throw std::runtime_error("enqueue on stopped ThreadPool");
+        PushBackground(Task([task]() { (*task)(); }));
 
-            m_tasks.emplace([task]() { (*task)(); });
-        }
-        m_condition.notify_one();
         return res;
     }
 
-} // namespace Fenrir
\ No newline at end of file
+} // namespace Fenrir
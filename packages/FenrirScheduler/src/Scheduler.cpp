@@ -1,11 +1,54 @@
 #include "FenrirScheduler/Scheduler.hpp"
 
-#include <future>
+#include <algorithm>
 #include <vector>
 namespace Fenrir
 {
+    SystemAccess& SystemAccess::WritesAll()
+    {
+        m_writesAll = true;
+        return *this;
+    }
+
+    SystemAccess SystemAccess::Undeclared()
+    {
+        SystemAccess access;
+        access.m_undeclared = true;
+        return access;
+    }
 
-    Scheduler::Scheduler() : m_runOnceSystems(), m_systems(), m_threadPool(std::thread::hardware_concurrency())
+    bool SystemAccess::ConflictsWith(const SystemAccess& other) const
+    {
+        // undeclared systems always ran side by side, so they keep doing that, but nothing declared can trust them
+        if (m_undeclared || other.m_undeclared)
+            return m_undeclared != other.m_undeclared;
+
+        if (m_writesAll || other.m_writesAll)
+            return true;
+
+        auto touches = [](const SystemAccess& access, const std::type_index& type) {
+            return std::find(access.m_reads.begin(), access.m_reads.end(), type) != access.m_reads.end() ||
+                   std::find(access.m_writes.begin(), access.m_writes.end(), type) != access.m_writes.end();
+        };
+
+        for (const auto& type : m_writes)
+        {
+            if (touches(other, type))
+                return true;
+        }
+
+        for (const auto& type : other.m_writes)
+        {
+            if (touches(*this, type))
+                return true;
+        }
+
+        return false;
+    }
+
+    Scheduler::Scheduler()
+        : m_runOnceSystems(), m_systems(), m_sequentialSystems(), m_plan(),
+          m_threadPool(std::thread::hardware_concurrency())
     {
     }
 
@@ -17,38 +60,141 @@ namespace Fenrir
 
     void Scheduler::RunSystems(App& app, SchedulePriority priority)
     {
-        if (m_systems.find(priority) != m_systems.end())
+        if (m_planDirty)
+            Finalize();
+
+        const size_t index = static_cast<size_t>(priority);
+        const Phase& phase = m_plan.phases[index];
+        TaskCounter& counter = m_plan.counters[index];
+        void* const context = TaskContext::Current();
+
+        for (uint32_t batch = phase.batchBegin; batch < phase.batchEnd; ++batch)
         {
-            std::vector<std::future<void>> futures;
-            for (auto& system : m_systems[priority])
+            // each task stores its captures inline and the counter is part of the plan, so no allocations are made
+            for (uint32_t i = m_plan.batches[batch].begin; i < m_plan.batches[batch].end; ++i)
             {
-                // system(app);
-                futures.emplace_back(m_threadPool.Enqueue([&app, &system] { system(app); }));
+                const SystemFunc& system = m_plan.parallelSystems[i];
+                const uint64_t key = TaskOrder::ForSystem(i);
+                m_threadPool.Dispatch(
+                    [&app, &system, key, context] {
+                        TaskOrder::Scope scope(key);
+                        TaskContext::Scope contextScope(context);
+                        system(app);
+                    },
+                    counter);
             }
 
-            for (auto& fut : futures)
+            m_threadPool.Wait(counter);
+        }
+
+        RunSequentialSystems(app, phase);
+
+        // anything the caller does from here on happened after the phase, so it sorts after every system in it
+        TaskOrder::SetRun(TaskOrder::GetRun() + 1);
+    }
+
+    void Scheduler::RunSystemsInline(App& app, SchedulePriority priority)
+    {
+        const Phase& phase = m_plan.phases[static_cast<size_t>(priority)];
+
+        // the systems keep the keys they would have had on the pool so commands play back in the same order
+        for (uint32_t batch = phase.batchBegin; batch < phase.batchEnd; ++batch)
+        {
+            for (uint32_t i = m_plan.batches[batch].begin; i < m_plan.batches[batch].end; ++i)
             {
-                fut.wait();
+                TaskOrder::Scope scope(TaskOrder::ForSystem(i));
+                m_plan.parallelSystems[i](app);
             }
         }
 
-        RunSequentialSystems(app, priority);
+        RunSequentialSystems(app, phase);
+
+        // anything the caller does from here on happened after the phase, so it sorts after every system in it
+        TaskOrder::SetRun(TaskOrder::GetRun() + 1);
+    }
+
+    bool Scheduler::IsFinalized() const
+    {
+        return !m_planDirty;
+    }
+
+    void Scheduler::RunSequentialSystems(App& app, const Phase& phase)
+    {
+        // sequential systems are keyed after every parallel system so they sort after them
+        const uint32_t sequentialKeyOffset = static_cast<uint32_t>(m_plan.parallelSystems.size());
+        for (uint32_t i = phase.sequentialBegin; i < phase.sequentialEnd; ++i)
+        {
+            TaskOrder::Scope scope(TaskOrder::ForSystem(sequentialKeyOffset + i));
+            m_plan.sequentialSystems[i](app);
+        }
+    }
+
+    void Scheduler::Finalize()
+    {
+        m_plan.parallelSystems.clear();
+        m_plan.batches.clear();
+        m_plan.sequentialSystems.clear();
+
+        for (size_t index = 0; index < SchedulePriorityCount; ++index)
+        {
+            Phase& phase = m_plan.phases[index];
+
+            CompileBatches(m_systems[index], phase);
+
+            phase.sequentialBegin = static_cast<uint32_t>(m_plan.sequentialSystems.size());
+            m_plan.sequentialSystems.insert(m_plan.sequentialSystems.end(), m_sequentialSystems[index].begin(),
+                                            m_sequentialSystems[index].end());
+            phase.sequentialEnd = static_cast<uint32_t>(m_plan.sequentialSystems.size());
+        }
+
+        m_planDirty = false;
     }
 
-    void Scheduler::RunSequentialSystems(App& app, SchedulePriority priority)
+    ThreadPool& Scheduler::GetThreadPool()
     {
-        if (m_sequentialSystems.find(priority) != m_sequentialSystems.end())
+        return m_threadPool;
+    }
+
+    const ThreadPool& Scheduler::GetThreadPool() const
+    {
+        return m_threadPool;
+    }
+
+    void Scheduler::CompileBatches(const std::vector<System>& systems, Phase& phase)
+    {
+        std::vector<size_t> batches(systems.size(), 0);
+        size_t batchCount = 0;
+        for (size_t i = 0; i < systems.size(); ++i)
         {
-            for (auto& system : m_sequentialSystems[priority])
+            for (size_t j = 0; j < i; ++j)
             {
-                system(app);
+                if (batches[j] >= batches[i] && systems[i].access.ConflictsWith(systems[j].access))
+                    batches[i] = batches[j] + 1;
             }
+
+            batchCount = std::max(batchCount, batches[i] + 1);
         }
+
+        phase.batchBegin = static_cast<uint32_t>(m_plan.batches.size());
+        for (size_t batch = 0; batch < batchCount; ++batch)
+        {
+            Batch range;
+            range.begin = static_cast<uint32_t>(m_plan.parallelSystems.size());
+            for (size_t i = 0; i < systems.size(); ++i)
+            {
+                if (batches[i] == batch)
+                    m_plan.parallelSystems.push_back(systems[i].func);
+            }
+            range.end = static_cast<uint32_t>(m_plan.parallelSystems.size());
+
+            m_plan.batches.push_back(range);
+        }
+        phase.batchEnd = static_cast<uint32_t>(m_plan.batches.size());
     }
 
     Scheduler& Scheduler::AddSystems(SchedulePriority priority, std::initializer_list<SystemFunc> systems)
     {
-        // for each system, add it to the map
+        // for each system, add it to its priority
         for (auto system : systems)
         {
             AddSystem(priority, system);
@@ -69,19 +215,27 @@ namespace Fenrir
 
     Scheduler& Scheduler::AddSequentialSystem(SchedulePriority priority, SystemFunc system)
     {
-        m_sequentialSystems[priority].push_back(system);
+        m_sequentialSystems[static_cast<size_t>(priority)].push_back(system);
+        m_planDirty = true;
         return *this;
     }
 
     Scheduler& Scheduler::AddSystem(SchedulePriority priority, SystemFunc system)
+    {
+        // nothing is known about what the system touches, so it is kept apart from systems that declared their access
+        return AddSystem(priority, std::move(system), SystemAccess::Undeclared());
+    }
+
+    Scheduler& Scheduler::AddSystem(SchedulePriority priority, SystemFunc system, SystemAccess access)
     {
         if (IsRunOnceSystem(priority))
         {
-            m_runOnceSystems[priority].push_back(system);
+            m_runOnceSystems[static_cast<size_t>(priority)].push_back(system);
         }
         else
         {
-            m_systems[priority].push_back(system);
+            m_systems[static_cast<size_t>(priority)].push_back({std::move(system), std::move(access)});
+            m_planDirty = true;
         }
         return *this;
     }
@@ -89,7 +243,7 @@ namespace Fenrir
     void Scheduler::Init(App& app)
     {
         // for each priority, run each system in order of their insertion
-        for (auto& [priority, systems] : m_runOnceSystems)
+        for (auto& systems : m_runOnceSystems)
         {
             for (auto& system : systems)
             {
@@ -97,4 +251,4 @@ namespace Fenrir
             }
         }
     }
-} // namespace Fenrir
\ No newline at end of file
+} // namespace Fenrir
@@ -0,0 +1,61 @@
+#include "FenrirScheduler/Task.hpp"
+
+namespace Fenrir
+{
+    Task::Task(Task&& other) noexcept
+        : m_invoke(other.m_invoke), m_move(other.m_move), m_destroy(other.m_destroy)
+    {
+        if (m_move)
+            m_move(m_storage, other.m_storage);
+
+        other.m_invoke = nullptr;
+        other.m_move = nullptr;
+        other.m_destroy = nullptr;
+    }
+
+    Task& Task::operator=(Task&& other) noexcept
+    {
+        if (this == &other)
+            return *this;
+
+        Reset();
+
+        m_invoke = other.m_invoke;
+        m_move = other.m_move;
+        m_destroy = other.m_destroy;
+
+        if (m_move)
+            m_move(m_storage, other.m_storage);
+
+        other.m_invoke = nullptr;
+        other.m_move = nullptr;
+        other.m_destroy = nullptr;
+
+        return *this;
+    }
+
+    Task::~Task()
+    {
+        Reset();
+    }
+
+    void Task::operator()()
+    {
+        m_invoke(m_storage);
+    }
+
+    Task::operator bool() const
+    {
+        return m_invoke != nullptr;
+    }
+
+    void Task::Reset()
+    {
+        if (m_destroy)
+            m_destroy(m_storage);
+
+        m_invoke = nullptr;
+        m_move = nullptr;
+        m_destroy = nullptr;
+    }
+} // namespace Fenrir
@@ -0,0 +1,24 @@
+#include "FenrirScheduler/TaskContext.hpp"
+
+namespace Fenrir
+{
+    namespace
+    {
+        thread_local void* t_currentContext = nullptr;
+    } // namespace
+
+    TaskContext::Scope::Scope(void* context) : m_previous(t_currentContext)
+    {
+        t_currentContext = context;
+    }
+
+    TaskContext::Scope::~Scope()
+    {
+        t_currentContext = m_previous;
+    }
+
+    void* TaskContext::Current()
+    {
+        return t_currentContext;
+    }
+} // namespace Fenrir
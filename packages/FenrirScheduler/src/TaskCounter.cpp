@@ -0,0 +1,48 @@
+#include "FenrirScheduler/TaskCounter.hpp"
+
+#include <thread>
+#include <utility>
+
+namespace Fenrir
+{
+    void TaskCounter::Add(uint32_t count)
+    {
+        m_count.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    void TaskCounter::Done()
+    {
+        // publishing zero must be the last access, the waiter polls and may destroy the counter straight after
+        m_count.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    void TaskCounter::Fail(std::exception_ptr exception)
+    {
+        if (!m_failed.exchange(true, std::memory_order_relaxed))
+            m_exception = std::move(exception);
+    }
+
+    void TaskCounter::Rethrow()
+    {
+        if (!m_failed.load(std::memory_order_relaxed))
+            return;
+
+        std::exception_ptr exception = std::move(m_exception);
+        m_exception = nullptr;
+        m_failed.store(false, std::memory_order_relaxed);
+        std::rethrow_exception(exception);
+    }
+
+    bool TaskCounter::IsDone() const
+    {
+        return m_count.load(std::memory_order_acquire) == 0;
+    }
+
+    void TaskCounter::Wait()
+    {
+        while (!IsDone())
+            std::this_thread::yield();
+
+        Rethrow();
+    }
+} // namespace Fenrir
@@ -0,0 +1,124 @@
+#include "FenrirScheduler/TaskOrder.hpp"
+
+#include <cassert>
+#include <stdexcept>
+
+namespace Fenrir
+{
+    namespace
+    {
+        /**
+         * @brief the bits of the low half of a key that hold the segment of each nesting level, outermost first
+         * A level that is all zero has not been used yet
+         *
+         */
+        struct SegmentLevel
+        {
+            uint32_t shift;
+            uint32_t bits;
+        };
+
+        constexpr SegmentLevel SegmentLevels[] = {{12, 20}, {0, 12}};
+
+        // the high half of a key holds the run above the system
+        constexpr uint32_t RunShift = 48;
+        constexpr uint32_t SystemShift = 32;
+        constexpr uint64_t RunMask = ~0ull << RunShift;
+
+        // the key the calling work was started with, and how many segments of it have been handed out since. The work
+        // itself is segment zero until it splits, after which it carries on as the segment following its chunks
+        thread_local uint64_t t_base = 0;
+        thread_local uint32_t t_segment = 0;
+
+        /**
+         * @brief Find the outermost nesting level that a key has not used yet
+         *
+         * @param key the key
+         * @return const SegmentLevel* the free level, or null if every level is used
+         */
+        const SegmentLevel* FreeLevel(uint64_t key)
+        {
+            for (const SegmentLevel& level : SegmentLevels)
+            {
+                if (((key >> level.shift) & ((1ull << level.bits) - 1)) == 0)
+                    return &level;
+            }
+            return nullptr;
+        }
+    } // namespace
+
+    TaskOrder::Scope::Scope(uint64_t key) : m_previousBase(t_base), m_previousSegment(t_segment)
+    {
+        t_base = key;
+        t_segment = 0;
+    }
+
+    TaskOrder::Scope::~Scope()
+    {
+        t_base = m_previousBase;
+        t_segment = m_previousSegment;
+    }
+
+    uint64_t TaskOrder::ChunkKeys::Get(uint32_t chunkIndex) const
+    {
+        return first + step * chunkIndex;
+    }
+
+    uint64_t TaskOrder::Current()
+    {
+        if (t_segment == 0)
+            return t_base;
+
+        return t_base | (static_cast<uint64_t>(t_segment) << FreeLevel(t_base)->shift);
+    }
+
+    uint64_t TaskOrder::ForSystem(uint32_t systemIndex)
+    {
+        assert(systemIndex + 1 < (1u << (RunShift - SystemShift)) && "too many systems for the key");
+
+        // the system lives in the high half so every chunk of a system sorts between it and the next system
+        return (t_base & RunMask) | ((static_cast<uint64_t>(systemIndex) + 1) << SystemShift);
+    }
+
+    uint64_t TaskOrder::ForRun(uint32_t run)
+    {
+        return static_cast<uint64_t>(run) << RunShift;
+    }
+
+    uint32_t TaskOrder::GetRun()
+    {
+        return static_cast<uint32_t>(t_base >> RunShift);
+    }
+
+    void TaskOrder::SetRun(uint32_t run)
+    {
+        // a run that wrapped around would share its keys with an earlier one and silently reorder what they record
+        if (run >= MaxRuns)
+            throw std::overflow_error("too many runs in one frame for the task order key");
+
+        t_base = (t_base & ~RunMask) | ForRun(run);
+    }
+
+    uint32_t TaskOrder::GetMaxChunks()
+    {
+        const SegmentLevel* level = FreeLevel(t_base);
+        if (!level)
+            return 0;
+
+        // one segment is kept back for the work that carries on after the chunks
+        const uint32_t last = static_cast<uint32_t>((1ull << level->bits) - 1);
+        return (last - t_segment > 1) ? last - t_segment - 1 : 0;
+    }
+
+    TaskOrder::ChunkKeys TaskOrder::Split(uint32_t chunkCount)
+    {
+        assert(chunkCount <= GetMaxChunks() && "split has more chunks than the key has room for");
+
+        const SegmentLevel* level = FreeLevel(t_base);
+        const uint64_t step = 1ull << level->shift;
+
+        ChunkKeys keys{t_base | (static_cast<uint64_t>(t_segment + 1) << level->shift), step};
+        t_segment += chunkCount + 1;
+        return keys;
+    }
+} // namespace Fenrir
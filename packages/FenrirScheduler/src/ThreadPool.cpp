@@ -1,33 +1,40 @@
 #include "FenrirScheduler/ThreadPool.hpp"
 
+#include <algorithm>
+
 namespace Fenrir
 {
-    ThreadPool::ThreadPool(size_t threads) : m_stop(false)
+    namespace
+    {
+        // the pool and worker index of the calling thread, used so a worker pushes onto its own deque
+        thread_local ThreadPool* t_pool = nullptr;
+        thread_local size_t t_workerIndex = 0;
+    } // namespace
+
+    ThreadPool::ThreadPool(size_t threads)
+        : m_pending(0), m_sleeping(0), m_overflow(), m_overflowPending(0), m_nextQueue(0), m_background(),
+          m_backgroundPending(0), m_backgroundRunning(0), m_stop(false)
     {
+        threads = std::max<size_t>(threads, 1);
+
+        // all slots are allocated up front so queueing a task never allocates
+        m_queues.reserve(threads);
         for (size_t i = 0; i < threads; ++i)
-            m_workers.emplace_back([this] {
-                for (;;)
-                {
-                    std::function<void()> task;
-
-                    {
-                        std::unique_lock<std::mutex> lock(this->m_queueMutex);
-                        this->m_condition.wait(lock, [this] { return this->m_stop || !this->m_tasks.empty(); });
-                        if (this->m_stop && this->m_tasks.empty())
-                            return;
-                        task = std::move(this->m_tasks.front());
-                        this->m_tasks.pop();
-                    }
-
-                    task();
-                }
-            });
+        {
+            auto queue = std::make_unique<WorkerQueue>();
+            queue->slots.resize(QueueCapacity);
+            m_queues.emplace_back(std::move(queue));
+        }
+
+        m_workers.reserve(threads);
+        for (size_t i = 0; i < threads; ++i)
+            m_workers.emplace_back([this, i] { WorkerLoop(i); });
     }
 
     ThreadPool::~ThreadPool()
     {
         {
-            std::unique_lock<std::mutex> lock(m_queueMutex);
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
             m_stop = true;
         }
         m_condition.notify_all();
@@ -35,4 +42,248 @@ namespace Fenrir
             worker.join();
     }
 
-} // namespace Fenrir
\ No newline at end of file
+    void ThreadPool::Dispatch(Task task, TaskCounter& counter)
+    {
+        counter.Add(1);
+        Push(std::move(task), &counter);
+    }
+
+    void ThreadPool::Wait(TaskCounter& counter)
+    {
+        size_t index = (t_pool == this) ? t_workerIndex : m_queues.size();
+
+        QueueSlot slot;
+        while (!counter.IsDone())
+        {
+            if ((index < m_queues.size() && TryPop(index, slot)) || TrySteal(index, slot))
+            {
+                Run(slot);
+                continue;
+            }
+
+            // the remaining tasks are running on other threads
+            std::this_thread::yield();
+        }
+
+        counter.Rethrow();
+    }
+
+    size_t ThreadPool::GetThreadCount() const
+    {
+        return m_workers.size();
+    }
+
+    size_t ThreadPool::GetCurrentWorkerIndex() const
+    {
+        return (t_pool == this) ? t_workerIndex : m_workers.size();
+    }
+
+    void ThreadPool::Push(Task task, TaskCounter* counter)
+    {
+        size_t start = (t_pool == this) ? t_workerIndex : m_nextQueue.fetch_add(1) % m_queues.size();
+
+        // count the task before it becomes visible so a worker can never pop it and underflow the counter
+        m_pending.fetch_add(1);
+
+        bool queued = false;
+        for (size_t offset = 0; offset < m_queues.size() && !queued; ++offset)
+        {
+            WorkerQueue& queue = *m_queues[(start + offset) % m_queues.size()];
+
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.size == QueueCapacity)
+                continue;
+
+            QueueSlot& slot = queue.slots[(queue.head + queue.size) % QueueCapacity];
+            slot.task = std::move(task);
+            slot.counter = counter;
+            ++queue.size;
+            queued = true;
+        }
+
+        if (!queued)
+        {
+            // every deque is full, running the task here could deadlock a caller holding a lock the task needs, so it
+            // waits in the overflow queue, which is the only place a push allocates
+            std::lock_guard<std::mutex> lock(m_overflowMutex);
+            m_overflow.push_back(QueueSlot{std::move(task), counter});
+            m_overflowPending.fetch_add(1);
+        }
+
+        // only touch the shared lock when someone is actually asleep, the lock/unlock pair makes sure a worker that is
+        // about to wait has either seen the new pending count or is already waiting when we notify
+        if (m_sleeping.load() > 0)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_sleepMutex);
+            }
+            m_condition.notify_one();
+        }
+    }
+
+    void ThreadPool::PushBackground(Task task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_backgroundMutex);
+            m_background.push_back(std::move(task));
+            m_backgroundPending.fetch_add(1);
+        }
+
+        if (m_sleeping.load() > 0)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_sleepMutex);
+            }
+            m_condition.notify_one();
+        }
+    }
+
+    bool ThreadPool::CanRunBackground() const
+    {
+        // keep a worker back for frame work, a single worker pool has nothing to keep back
+        const size_t limit = std::max<size_t>(m_queues.size(), 2) - 1;
+        return m_backgroundPending.load() > 0 && m_backgroundRunning.load() < limit;
+    }
+
+    bool ThreadPool::TryRunBackground()
+    {
+        if (!CanRunBackground())
+            return false;
+
+        Task task;
+        {
+            std::lock_guard<std::mutex> lock(m_backgroundMutex);
+            if (!CanRunBackground())
+                return false;
+
+            task = std::move(m_background.front());
+            m_background.pop_front();
+            m_backgroundPending.fetch_sub(1);
+            ++m_backgroundRunning;
+        }
+
+        // background tasks come from EnqueueBackground, whose packaged task keeps any exception for its future
+        task();
+        task = Task();
+
+        {
+            std::lock_guard<std::mutex> lock(m_backgroundMutex);
+            --m_backgroundRunning;
+        }
+
+        // another worker may have gone to sleep while this one held the last background slot
+        if (m_backgroundPending.load() > 0 && m_sleeping.load() > 0)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_sleepMutex);
+            }
+            m_condition.notify_one();
+        }
+
+        return true;
+    }
+
+    bool ThreadPool::TryPop(size_t index, QueueSlot& slot)
+    {
+        WorkerQueue& queue = *m_queues[index];
+
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.size == 0)
+            return false;
+
+        --queue.size;
+        QueueSlot& back = queue.slots[(queue.head + queue.size) % QueueCapacity];
+        slot.task = std::move(back.task);
+        slot.counter = back.counter;
+        m_pending.fetch_sub(1);
+        return true;
+    }
+
+    bool ThreadPool::TrySteal(size_t index, QueueSlot& slot)
+    {
+        for (size_t offset = 1; offset <= m_queues.size(); ++offset)
+        {
+            size_t victimIndex = (index + offset) % m_queues.size();
+            if (victimIndex == index)
+                continue;
+
+            WorkerQueue& victim = *m_queues[victimIndex];
+
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (victim.size == 0)
+                continue;
+
+            QueueSlot& front = victim.slots[victim.head];
+            slot.task = std::move(front.task);
+            slot.counter = front.counter;
+            victim.head = (victim.head + 1) % QueueCapacity;
+            --victim.size;
+            m_pending.fetch_sub(1);
+            return true;
+        }
+
+        if (m_overflowPending.load() == 0)
+            return false;
+
+        std::lock_guard<std::mutex> lock(m_overflowMutex);
+        if (m_overflow.empty())
+            return false;
+
+        slot.task = std::move(m_overflow.front().task);
+        slot.counter = m_overflow.front().counter;
+        m_overflow.pop_front();
+        m_overflowPending.fetch_sub(1);
+        m_pending.fetch_sub(1);
+        return true;
+    }
+
+    void ThreadPool::Run(QueueSlot& slot)
+    {
+        // a throwing task must still lower its counter, otherwise its waiter would spin forever, so the exception is
+        // handed to the counter and rethrown on the waiting thread instead
+        try
+        {
+            slot.task();
+        }
+        catch (...)
+        {
+            if (slot.counter)
+                slot.counter->Fail(std::current_exception());
+        }
+        slot.task = Task();
+
+        if (slot.counter)
+            slot.counter->Done();
+    }
+
+    void ThreadPool::WorkerLoop(size_t index)
+    {
+        t_pool = this;
+        t_workerIndex = index;
+
+        QueueSlot slot;
+        for (;;)
+        {
+            if (TryPop(index, slot) || TrySteal(index, slot))
+            {
+                Run(slot);
+                continue;
+            }
+
+            // background work is only picked up once there is no frame work left to take
+            if (TryRunBackground())
+                continue;
+
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_sleeping.fetch_add(1);
+            m_condition.wait(lock, [this] {
+                return m_stop.load() || m_pending.load() > 0 || CanRunBackground();
+            });
+            m_sleeping.fetch_sub(1);
+
+            if (m_stop.load() && m_pending.load() == 0 && m_backgroundPending.load() == 0)
+                return;
+        }
+    }
+
+} // namespace Fenrir
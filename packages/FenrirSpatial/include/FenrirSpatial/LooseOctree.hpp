@@ -0,0 +1,138 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "SpatialIndex.hpp"
+
+namespace Fenrir
+{
+    /**
+     * @brief A spatial index that splits a cube of the world into eight children at each level. Every node's bounds
+     * are loosened to twice its size, so an id is stored in the deepest node its sphere fits in by its center alone
+     * and never has to be split across nodes. It copes better than a grid with ids of very different sizes or that
+     * are clustered together. Ids whose center is outside the cube are kept in the root, which still works but is
+     * not any faster than a linear scan for them
+     *
+     */
+    class LooseOctree : public SpatialIndex
+    {
+      public:
+        /**
+         * @brief Construct a new Loose Octree object
+         *
+         * @param center the center of the cube the octree covers
+         * @param halfSize half the length of each side of the cube
+         * @param maxDepth the most levels below the root, each level halves the size of a node
+         */
+        LooseOctree(const Math::Point& center, float halfSize, uint32_t maxDepth = 8);
+
+        void Set(uint32_t id, const Math::Point& center, float radius) override;
+
+        void Remove(uint32_t id) override;
+
+        bool Contains(uint32_t id) const override;
+
+        void Clear() override;
+
+        size_t GetCount() const override;
+
+        void GetIds(std::vector<uint32_t>& ids) const override;
+
+        void QueryRadius(const Math::Point& center, float radius, std::vector<uint32_t>& results) const override;
+
+        void QueryAABB(const Math::AABB& box, std::vector<uint32_t>& results) const override;
+
+        void QueryRay(const Math::Ray& ray, float maxDistance, std::vector<uint32_t>& results) const override;
+
+        /**
+         * @brief Get the number of nodes, nodes are kept once made until the octree is cleared
+         *
+         * @return size_t the number of nodes
+         */
+        size_t GetNodeCount() const;
+
+      private:
+        static constexpr uint32_t NoNode = 0; // the root is never a child so zero can mean no child
+
+        struct Node
+        {
+            Math::Point center;
+            float halfSize;
+            uint32_t depth;
+            uint32_t parent;
+            uint32_t count; // the number of ids in this node and every node below it
+            std::array<uint32_t, 8> children;
+            std::vector<uint32_t> slots; // indexes into m_entries
+        };
+
+        struct Entry
+        {
+            uint32_t id;
+            Math::Point center;
+            float radius;
+            uint32_t node;
+            uint32_t position; // index into the node's slots
+        };
+
+        Math::Point m_center;
+        float m_halfSize;
+        uint32_t m_maxDepth;
+
+        std::vector<Node> m_nodes;
+        std::vector<Entry> m_entries;
+        std::unordered_map<uint32_t, uint32_t> m_slots; // id to index into m_entries
+
+        /**
+         * @brief Find the deepest node a sphere fits in, making any nodes on the way that do not exist yet
+         *
+         * @param center the center of the sphere
+         * @param radius the radius of the sphere
+         * @return uint32_t the index of the node
+         */
+        uint32_t FindNode(const Math::Point& center, float radius);
+
+        /**
+         * @brief Add an entry to a node and count it in the node and its parents
+         *
+         * @param slot the index of the entry
+         * @param node the index of the node
+         */
+        void Link(uint32_t slot, uint32_t node);
+
+        /**
+         * @brief Take an entry out of its node and stop counting it in the node and its parents
+         *
+         * @param slot the index of the entry
+         */
+        void Unlink(uint32_t slot);
+
+        /**
+         * @brief Make the root node, used on construction and after clearing
+         *
+         */
+        void MakeRoot();
+
+        /**
+         * @brief Get the loose bounds of a node, which everything stored in it fits inside
+         *
+         * @param node the node
+         * @return Math::AABB the bounds
+         */
+        static Math::AABB LooseBounds(const Node& node);
+
+        /**
+         * @brief Call a function on every entry in the nodes whose loose bounds overlap a region, the root is always
+         * visited as it also holds the ids outside the octree
+         *
+         * @tparam Overlaps the overlap test type
+         * @tparam Func the function type
+         * @param overlaps to call with the loose bounds of a node, returns true if the region overlaps them
+         * @param func to call with each entry
+         */
+        template <typename Overlaps, typename Func>
+        void ForEachInNodes(const Overlaps& overlaps, Func&& func) const;
+    };
+} // namespace Fenrir
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "FenrirMath/Math.hpp"
+#include "FenrirScheduler/TaskCounter.hpp"
+#include "FenrirScheduler/ThreadPool.hpp"
+
+namespace Fenrir
+{
+    /**
+     * @brief A query for everything within a radius of a point
+     *
+     */
+    struct RadiusQuery
+    {
+        Math::Point center;
+        float radius = 0.0f;
+    };
+
+    /**
+     * @brief Interface for spatial indexes
+     * An index stores a bounding sphere for each id and answers which ids overlap a region, without looking at every
+     * id. Queries are const and never change the index, so any number of them can run at once as long as nothing is
+     * being added or removed
+     *
+     */
+    class SpatialIndex
+    {
+      public:
+        /**
+         * @brief Destroy the Spatial Index object
+         *
+         */
+        virtual ~SpatialIndex() = default;
+
+        /**
+         * @brief Add an id to the index, or move it if it is already in the index
+         *
+         * @param id the id, usually an entity id
+         * @param center the center of its bounding sphere
+         * @param radius the radius of its bounding sphere, zero for a point
+         */
+        virtual void Set(uint32_t id, const Math::Point& center, float radius) = 0;
+
+        /**
+         * @brief Remove an id from the index, does nothing if it is not in the index
+         *
+         * @param id the id
+         */
+        virtual void Remove(uint32_t id) = 0;
+
+        /**
+         * @brief Check if an id is in the index
+         *
+         * @param id the id
+         * @return true if it is in the index
+         */
+        virtual bool Contains(uint32_t id) const = 0;
+
+        /**
+         * @brief Remove every id from the index
+         *
+         */
+        virtual void Clear() = 0;
+
+        /**
+         * @brief Get the number of ids in the index
+         *
+         * @return size_t the number of ids
+         */
+        virtual size_t GetCount() const = 0;
+
+        /**
+         * @brief Get every id in the index
+         *
+         * @param ids the vector the ids are appended to
+         */
+        virtual void GetIds(std::vector<uint32_t>& ids) const = 0;
+
+        /**
+         * @brief Find every id whose sphere overlaps a sphere
+         *
+         * @param center the center of the sphere
+         * @param radius the radius of the sphere
+         * @param results the vector the ids are appended to, each id is appended once
+         */
+        virtual void QueryRadius(const Math::Point& center, float radius, std::vector<uint32_t>& results) const = 0;
+
+        /**
+         * @brief Find every id whose sphere overlaps a box
+         *
+         * @param box the box
+         * @param results the vector the ids are appended to, each id is appended once
+         */
+        virtual void QueryAABB(const Math::AABB& box, std::vector<uint32_t>& results) const = 0;
+
+        /**
+         * @brief Find every id whose sphere is hit by a ray
+         *
+         * @param ray the ray, its direction must be normalized
+         * @param maxDistance how far along the ray to look, it must be finite
+         * @param results the vector the ids are appended to, each id is appended once in the order they are hit
+         */
+        virtual void QueryRay(const Math::Ray& ray, float maxDistance, std::vector<uint32_t>& results) const = 0;
+
+        /**
+         * @brief Run many radius queries at once on the thread pool
+         *
+         * @param queries the queries
+         * @param results the results of each query, resized to the number of queries and cleared first
+         * @param threadPool the thread pool to run on, or nullptr to run on the calling thread
+         * @param grainSize the number of queries in each task
+         */
+        void QueryRadiusBatch(const std::vector<RadiusQuery>& queries, std::vector<std::vector<uint32_t>>& results,
+                              ThreadPool* threadPool, size_t grainSize = 64) const;
+
+        /**
+         * @brief Run many box queries at once on the thread pool
+         *
+         * @param queries the boxes
+         * @param results the results of each query, resized to the number of queries and cleared first
+         * @param threadPool the thread pool to run on, or nullptr to run on the calling thread
+         * @param grainSize the number of queries in each task
+         */
+        void QueryAABBBatch(const std::vector<Math::AABB>& queries, std::vector<std::vector<uint32_t>>& results,
+                            ThreadPool* threadPool, size_t grainSize = 64) const;
+
+      protected:
+        /**
+         * @brief Check if two spheres overlap
+         *
+         * @return true if they overlap
+         */
+        static bool SpheresOverlap(const Math::Point& a, float radiusA, const Math::Point& b, float radiusB);
+
+        /**
+         * @brief Check if a sphere overlaps a box
+         *
+         * @return true if they overlap
+         */
+        static bool SphereOverlapsAABB(const Math::Point& center, float radius, const Math::AABB& box);
+
+        /**
+         * @brief Find where a ray first touches a sphere
+         *
+         * @param ray the ray
+         * @param maxDistance how far along the ray to look
+         * @param center the center of the sphere
+         * @param radius the radius of the sphere
+         * @param distance set to the distance along the ray of the hit, zero if the ray starts inside the sphere
+         * @return true if the ray hits the sphere within maxDistance
+         */
+        static bool RayHitsSphere(const Math::Ray& ray, float maxDistance, const Math::Point& center, float radius,
+                                  float& distance);
+
+        /**
+         * @brief Find where a ray enters a box
+         *
+         * @param ray the ray
+         * @param maxDistance how far along the ray to look
+         * @param box the box
+         * @return true if the ray touches the box within maxDistance
+         */
+        static bool RayHitsAABB(const Math::Ray& ray, float maxDistance, const Math::AABB& box);
+
+      private:
+        /**
+         * @brief Split a batch into chunks and run them on the thread pool
+         *
+         * @tparam Func the function type
+         * @param count the number of queries
+         * @param threadPool the thread pool, or nullptr to run on the calling thread
+         * @param grainSize the number of queries in each chunk
+         * @param func to call with the begin and end of each chunk
+         */
+        template <typename Func>
+        static void RunBatch(size_t count, ThreadPool* threadPool, size_t grainSize, const Func& func);
+    };
+
+    template <typename Func>
+    void SpatialIndex::RunBatch(size_t count, ThreadPool* threadPool, size_t grainSize, const Func& func)
+    {
+        if (grainSize == 0)
+            grainSize = 1;
+
+        if (!threadPool || count <= grainSize)
+        {
+            func(size_t(0), count);
+            return;
+        }
+
+        TaskCounter counter;
+        for (size_t begin = 0; begin < count; begin += grainSize)
+        {
+            const size_t end = std::min(begin + grainSize, count);
+            threadPool->Dispatch([&func, begin, end] { func(begin, end); }, counter);
+        }
+
+        threadPool->Wait(counter);
+    }
+} // namespace Fenrir
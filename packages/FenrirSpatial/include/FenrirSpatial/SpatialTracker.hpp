@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "FenrirECS/EntityList.hpp"
+
+#include "SpatialIndex.hpp"
+
+namespace Fenrir
+{
+    /**
+     * @brief Marks an entity to be kept in a spatial index, centered on its Transform position
+     *
+     */
+    struct SpatialBody
+    {
+        float radius = 0.0f; ///< The radius of its bounding sphere before scaling, zero for a point.
+    };
+
+    /**
+     * @brief Keeps a spatial index up to date with the entities of an entity list that have a Transform and a
+     * SpatialBody. Both types are tracked for changes, so an update moves every entity whose Transform or SpatialBody
+     * was added, replaced, patched or changed in place and marked with EntityList::MarkComponentChanged or
+     * EntityList::MarkTransformDirty. An observer records the entities that lost either, so removals only visit
+     * those entities. The position used is Transform::pos, so children in a hierarchy are indexed by their local
+     * position and need to be kept out of the index or given world positions by the caller
+     *
+     */
+    class SpatialTracker
+    {
+      public:
+        /**
+         * @brief Construct a new Spatial Tracker object
+         *
+         * @param index the index to keep up to date
+         */
+        SpatialTracker(std::unique_ptr<SpatialIndex> index);
+
+        /**
+         * @brief Destroy the Spatial Tracker object, untracking the entity list it tracks
+         *
+         */
+        ~SpatialTracker();
+
+        SpatialTracker(const SpatialTracker&) = delete;
+
+        SpatialTracker& operator=(const SpatialTracker&) = delete;
+
+        /**
+         * @brief Start tracking the Transform and SpatialBody changes of an entity list and add the entities that
+         * already have both, this must be called once before the first update. Both types are passed to
+         * EntityList::TrackChanges. The entity list must outlive the tracker or be untracked first
+         *
+         * @param entityList the entity list
+         */
+        void Track(EntityList& entityList);
+
+        /**
+         * @brief Stop watching the entity list passed to Track, the index keeps what it holds
+         *
+         */
+        void Untrack();
+
+        /**
+         * @brief Move every entity whose Transform or SpatialBody changed since the last update, add new ones and
+         * remove ones that are gone. Finding the changed entities checks the change ticks of every tracked entity.
+         * This must not run while the index is being queried or the components are being written
+         *
+         * @param entityList the entity list passed to Track
+         */
+        void Update(EntityList& entityList);
+
+        /**
+         * @brief Get the index
+         *
+         * @return const SpatialIndex& the index
+         */
+        const SpatialIndex& GetIndex() const;
+
+      private:
+        std::unique_ptr<SpatialIndex> m_index;
+        EntityList* m_entityList;
+        Observer* m_removed; // entities that lost their Transform or SpatialBody
+        uint32_t m_lastTick; // the change tick claimed at the end of the last update
+
+        /**
+         * @brief Set an entity in the index from its components
+         *
+         * @param id the id of the entity
+         * @param transform its transform
+         * @param body its body
+         */
+        void Set(uint32_t id, const Transform& transform, const SpatialBody& body);
+    };
+} // namespace Fenrir
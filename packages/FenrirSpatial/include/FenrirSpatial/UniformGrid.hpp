@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "SpatialIndex.hpp"
+
+namespace Fenrir
+{
+    /**
+     * @brief A spatial index that buckets ids into cubic cells of a fixed size, kept in a hash map so only occupied
+     * cells use memory and the world has no bounds. It works best when ids are spread evenly and queries are around
+     * the size of a cell, moving an id within its cells only updates its sphere. Spheres that would cover more than
+     * MaxCellsPerEntry cells are kept in a separate list that every query checks, so a single huge sphere never has to
+     * be listed in an unbounded number of cells
+     *
+     */
+    class UniformGrid : public SpatialIndex
+    {
+      public:
+        static constexpr int64_t MaxCellsPerEntry = 64;
+
+        /**
+         * @brief Construct a new Uniform Grid object
+         *
+         * @param cellSize the length of each side of a cell
+         */
+        UniformGrid(float cellSize);
+
+        void Set(uint32_t id, const Math::Point& center, float radius) override;
+
+        void Remove(uint32_t id) override;
+
+        bool Contains(uint32_t id) const override;
+
+        void Clear() override;
+
+        size_t GetCount() const override;
+
+        void GetIds(std::vector<uint32_t>& ids) const override;
+
+        void QueryRadius(const Math::Point& center, float radius, std::vector<uint32_t>& results) const override;
+
+        void QueryAABB(const Math::AABB& box, std::vector<uint32_t>& results) const override;
+
+        void QueryRay(const Math::Ray& ray, float maxDistance, std::vector<uint32_t>& results) const override;
+
+        /**
+         * @brief Get the size of each cell
+         *
+         * @return float the length of each side of a cell
+         */
+        float GetCellSize() const;
+
+      private:
+        struct Cell
+        {
+            int32_t x;
+            int32_t y;
+            int32_t z;
+
+            bool operator==(const Cell& other) const = default;
+        };
+
+        struct Entry
+        {
+            uint32_t id;
+            Math::Point center;
+            float radius;
+
+            // the range of cells the sphere overlaps, it is listed in every one of them unless it is large
+            Cell min;
+            Cell max;
+            uint32_t large; // the index into m_large, or NotLarge
+        };
+
+        static constexpr uint32_t NotLarge = 0xFFFFFFFF;
+
+        float m_cellSize;
+        float m_inverseCellSize;
+
+        std::vector<Entry> m_entries;
+        std::unordered_map<uint32_t, uint32_t> m_slots; // id to index into m_entries
+        std::unordered_map<uint64_t, std::vector<uint32_t>> m_cells;
+        std::vector<uint32_t> m_large; // entries covering too many cells to list in each of them
+
+        /**
+         * @brief Get the cell a point is in
+         *
+         * @param point the point
+         * @return Cell the cell
+         */
+        Cell CellOf(const Math::Point& point) const;
+
+        /**
+         * @brief Pack a cell into a hash map key
+         *
+         * @param cell the cell
+         * @return uint64_t the key
+         */
+        static uint64_t KeyOf(const Cell& cell);
+
+        /**
+         * @brief Get the number of cells in a range
+         *
+         * @param min the first cell of the range
+         * @param max the last cell of the range
+         * @return int64_t the number of cells
+         */
+        static int64_t CellCount(const Cell& min, const Cell& max);
+
+        /**
+         * @brief Check if an entry's range of cells overlaps a range
+         *
+         * @param entry the entry
+         * @param min the first cell of the range
+         * @param max the last cell of the range
+         * @return true if they overlap
+         */
+        static bool Overlaps(const Entry& entry, const Cell& min, const Cell& max);
+
+        /**
+         * @brief List an entry in every cell in its range, or in the large list if the range is too big
+         *
+         * @param slot the index of the entry
+         */
+        void AddToCells(uint32_t slot);
+
+        /**
+         * @brief Take an entry out of every cell in its range, or out of the large list
+         *
+         * @param slot the index of the entry
+         */
+        void RemoveFromCells(uint32_t slot);
+
+        /**
+         * @brief Change the index an entry is listed under in its cells or the large list
+         *
+         * @param from the old index
+         * @param to the new index
+         */
+        void RelinkInCells(uint32_t from, uint32_t to);
+
+        /**
+         * @brief Call a function on every entry listed in a range of cells, once per entry
+         *
+         * @tparam Func the function type
+         * @param min the first cell of the range
+         * @param max the last cell of the range
+         * @param func to call with each entry
+         */
+        template <typename Func>
+        void ForEachInCells(const Cell& min, const Cell& max, Func&& func) const;
+    };
+} // namespace Fenrir
@@ -0,0 +1,249 @@
+#include "FenrirSpatial/LooseOctree.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace Fenrir
+{
+    LooseOctree::LooseOctree(const Math::Point& center, float halfSize, uint32_t maxDepth)
+        : m_center(center), m_halfSize(halfSize), m_maxDepth(maxDepth), m_nodes(), m_entries(), m_slots()
+    {
+        MakeRoot();
+    }
+
+    template <typename Overlaps, typename Func>
+    void LooseOctree::ForEachInNodes(const Overlaps& overlaps, Func&& func) const
+    {
+        std::vector<uint32_t> stack;
+        stack.push_back(0);
+
+        while (!stack.empty())
+        {
+            const Node& node = m_nodes[stack.back()];
+            stack.pop_back();
+
+            for (const uint32_t slot : node.slots)
+                func(m_entries[slot]);
+
+            for (const uint32_t child : node.children)
+            {
+                if (child != NoNode && m_nodes[child].count > 0 && overlaps(LooseBounds(m_nodes[child])))
+                    stack.push_back(child);
+            }
+        }
+    }
+
+    void LooseOctree::Set(uint32_t id, const Math::Point& center, float radius)
+    {
+        const uint32_t node = FindNode(center, radius);
+
+        auto it = m_slots.find(id);
+        if (it != m_slots.end())
+        {
+            Entry& entry = m_entries[it->second];
+            entry.center = center;
+            entry.radius = radius;
+
+            // small moves usually stay in the same node thanks to the loose bounds
+            if (entry.node == node)
+                return;
+
+            Unlink(it->second);
+            Link(it->second, node);
+            return;
+        }
+
+        const uint32_t slot = static_cast<uint32_t>(m_entries.size());
+        m_entries.push_back({id, center, radius, NoNode, 0});
+        m_slots.emplace(id, slot);
+        Link(slot, node);
+    }
+
+    void LooseOctree::Remove(uint32_t id)
+    {
+        auto it = m_slots.find(id);
+        if (it == m_slots.end())
+            return;
+
+        const uint32_t slot = it->second;
+        const uint32_t last = static_cast<uint32_t>(m_entries.size() - 1);
+        Unlink(slot);
+        m_slots.erase(it);
+
+        // fill the gap with the last entry so the entries stay packed
+        if (slot != last)
+        {
+            m_entries[slot] = m_entries[last];
+            m_nodes[m_entries[slot].node].slots[m_entries[slot].position] = slot;
+            m_slots[m_entries[slot].id] = slot;
+        }
+
+        m_entries.pop_back();
+    }
+
+    bool LooseOctree::Contains(uint32_t id) const
+    {
+        return m_slots.contains(id);
+    }
+
+    void LooseOctree::Clear()
+    {
+        m_nodes.clear();
+        m_entries.clear();
+        m_slots.clear();
+        MakeRoot();
+    }
+
+    size_t LooseOctree::GetCount() const
+    {
+        return m_entries.size();
+    }
+
+    void LooseOctree::GetIds(std::vector<uint32_t>& ids) const
+    {
+        for (const Entry& entry : m_entries)
+            ids.push_back(entry.id);
+    }
+
+    void LooseOctree::QueryRadius(const Math::Point& center, float radius, std::vector<uint32_t>& results) const
+    {
+        ForEachInNodes([&](const Math::AABB& bounds) { return SphereOverlapsAABB(center, radius, bounds); },
+                       [&](const Entry& entry) {
+                           if (SpheresOverlap(center, radius, entry.center, entry.radius))
+                               results.push_back(entry.id);
+                       });
+    }
+
+    void LooseOctree::QueryAABB(const Math::AABB& box, std::vector<uint32_t>& results) const
+    {
+        auto overlaps = [&box](const Math::AABB& bounds) {
+            return bounds.min.x <= box.max.x && bounds.max.x >= box.min.x && bounds.min.y <= box.max.y &&
+                   bounds.max.y >= box.min.y && bounds.min.z <= box.max.z && bounds.max.z >= box.min.z;
+        };
+
+        ForEachInNodes(overlaps, [&](const Entry& entry) {
+            if (SphereOverlapsAABB(entry.center, entry.radius, box))
+                results.push_back(entry.id);
+        });
+    }
+
+    void LooseOctree::QueryRay(const Math::Ray& ray, float maxDistance, std::vector<uint32_t>& results) const
+    {
+        std::vector<std::pair<float, uint32_t>> hits;
+
+        ForEachInNodes([&](const Math::AABB& bounds) { return RayHitsAABB(ray, maxDistance, bounds); },
+                       [&](const Entry& entry) {
+                           float distance;
+                           if (RayHitsSphere(ray, maxDistance, entry.center, entry.radius, distance))
+                               hits.emplace_back(distance, entry.id);
+                       });
+
+        std::sort(hits.begin(), hits.end());
+        for (const auto& hit : hits)
+            results.push_back(hit.second);
+    }
+
+    size_t LooseOctree::GetNodeCount() const
+    {
+        return m_nodes.size();
+    }
+
+    uint32_t LooseOctree::FindNode(const Math::Point& center, float radius)
+    {
+        // anything with its center outside the octree can only go in the root
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (std::abs(center[axis] - m_center[axis]) > m_halfSize)
+                return 0;
+        }
+
+        uint32_t current = 0;
+        while (m_nodes[current].depth < m_maxDepth)
+        {
+            const float childHalfSize = m_nodes[current].halfSize * 0.5f;
+
+            // the center is inside the child, so the sphere is inside its loose bounds as long as it is no bigger
+            if (radius > childHalfSize)
+                break;
+
+            const Math::Point& nodeCenter = m_nodes[current].center;
+            const uint32_t octant = (center.x >= nodeCenter.x ? 1u : 0u) | (center.y >= nodeCenter.y ? 2u : 0u) |
+                                    (center.z >= nodeCenter.z ? 4u : 0u);
+
+            if (m_nodes[current].children[octant] == NoNode)
+            {
+                Node child;
+                child.center = nodeCenter;
+                child.center.x += (octant & 1u) ? childHalfSize : -childHalfSize;
+                child.center.y += (octant & 2u) ? childHalfSize : -childHalfSize;
+                child.center.z += (octant & 4u) ? childHalfSize : -childHalfSize;
+                child.halfSize = childHalfSize;
+                child.depth = m_nodes[current].depth + 1;
+                child.parent = current;
+                child.count = 0;
+                child.children.fill(NoNode);
+
+                // push_back can move the nodes, so current is indexed again afterwards
+                m_nodes.push_back(std::move(child));
+                m_nodes[current].children[octant] = static_cast<uint32_t>(m_nodes.size() - 1);
+            }
+
+            current = m_nodes[current].children[octant];
+        }
+
+        return current;
+    }
+
+    void LooseOctree::Link(uint32_t slot, uint32_t node)
+    {
+        Entry& entry = m_entries[slot];
+        entry.node = node;
+        entry.position = static_cast<uint32_t>(m_nodes[node].slots.size());
+        m_nodes[node].slots.push_back(slot);
+
+        for (uint32_t current = node;; current = m_nodes[current].parent)
+        {
+            ++m_nodes[current].count;
+            if (current == 0)
+                break;
+        }
+    }
+
+    void LooseOctree::Unlink(uint32_t slot)
+    {
+        const Entry& entry = m_entries[slot];
+        std::vector<uint32_t>& slots = m_nodes[entry.node].slots;
+
+        // swap the last slot of the node into the gap and tell its entry where it moved to
+        slots[entry.position] = slots.back();
+        m_entries[slots.back()].position = entry.position;
+        slots.pop_back();
+
+        for (uint32_t current = entry.node;; current = m_nodes[current].parent)
+        {
+            --m_nodes[current].count;
+            if (current == 0)
+                break;
+        }
+    }
+
+    void LooseOctree::MakeRoot()
+    {
+        Node root;
+        root.center = m_center;
+        root.halfSize = m_halfSize;
+        root.depth = 0;
+        root.parent = 0;
+        root.count = 0;
+        root.children.fill(NoNode);
+
+        m_nodes.push_back(std::move(root));
+    }
+
+    Math::AABB LooseOctree::LooseBounds(const Node& node)
+    {
+        const Math::Vec3 extent(node.halfSize * 2.0f);
+        return Math::AABB{node.center - extent, node.center + extent};
+    }
+} // namespace Fenrir
@@ -0,0 +1,104 @@
+#include "FenrirSpatial/SpatialIndex.hpp"
+
+#include <cmath>
+#include <utility>
+
+namespace Fenrir
+{
+    void SpatialIndex::QueryRadiusBatch(const std::vector<RadiusQuery>& queries,
+                                        std::vector<std::vector<uint32_t>>& results, ThreadPool* threadPool,
+                                        size_t grainSize) const
+    {
+        results.resize(queries.size());
+        RunBatch(queries.size(), threadPool, grainSize, [this, &queries, &results](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+            {
+                results[i].clear();
+                QueryRadius(queries[i].center, queries[i].radius, results[i]);
+            }
+        });
+    }
+
+    void SpatialIndex::QueryAABBBatch(const std::vector<Math::AABB>& queries,
+                                      std::vector<std::vector<uint32_t>>& results, ThreadPool* threadPool,
+                                      size_t grainSize) const
+    {
+        results.resize(queries.size());
+        RunBatch(queries.size(), threadPool, grainSize, [this, &queries, &results](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+            {
+                results[i].clear();
+                QueryAABB(queries[i], results[i]);
+            }
+        });
+    }
+
+    bool SpatialIndex::SpheresOverlap(const Math::Point& a, float radiusA, const Math::Point& b, float radiusB)
+    {
+        const float radius = radiusA + radiusB;
+        return Math::DistanceSq(a, b) <= radius * radius;
+    }
+
+    bool SpatialIndex::SphereOverlapsAABB(const Math::Point& center, float radius, const Math::AABB& box)
+    {
+        // the distance from the center to the closest point of the box
+        float distanceSq = 0.0f;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            const float v = center[axis];
+            if (v < box.min[axis])
+                distanceSq += (box.min[axis] - v) * (box.min[axis] - v);
+            else if (v > box.max[axis])
+                distanceSq += (v - box.max[axis]) * (v - box.max[axis]);
+        }
+
+        return distanceSq <= radius * radius;
+    }
+
+    bool SpatialIndex::RayHitsSphere(const Math::Ray& ray, float maxDistance, const Math::Point& center, float radius,
+                                     float& distance)
+    {
+        const Math::Vec3 toCenter = center - ray.origin;
+        const float closest = Math::Dot(toCenter, ray.dir);
+        const float missSq = Math::MagnitudeSq(toCenter) - closest * closest;
+        if (missSq > radius * radius)
+            return false;
+
+        const float halfChord = std::sqrt(radius * radius - missSq);
+        if (closest + halfChord < 0.0f)
+            return false;
+
+        distance = std::max(closest - halfChord, 0.0f);
+        return distance <= maxDistance;
+    }
+
+    bool SpatialIndex::RayHitsAABB(const Math::Ray& ray, float maxDistance, const Math::AABB& box)
+    {
+        // slab test, an axis the ray is parallel to gives infinite distances which the min and max handle
+        float nearest = 0.0f;
+        float farthest = maxDistance;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            const float inverse = 1.0f / ray.dir[axis];
+            float entry = (box.min[axis] - ray.origin[axis]) * inverse;
+            float leave = (box.max[axis] - ray.origin[axis]) * inverse;
+            if (entry > leave)
+                std::swap(entry, leave);
+
+            // a parallel ray that starts on a slab face gives nan, which only misses if the ray is outside the slab
+            if (std::isnan(entry) || std::isnan(leave))
+            {
+                if (ray.origin[axis] < box.min[axis] || ray.origin[axis] > box.max[axis])
+                    return false;
+                continue;
+            }
+
+            nearest = std::max(nearest, entry);
+            farthest = std::min(farthest, leave);
+            if (nearest > farthest)
+                return false;
+        }
+
+        return true;
+    }
+} // namespace Fenrir
@@ -0,0 +1,75 @@
+#include "FenrirSpatial/SpatialTracker.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Fenrir
+{
+    SpatialTracker::SpatialTracker(std::unique_ptr<SpatialIndex> index)
+        : m_index(std::move(index)), m_entityList(nullptr), m_removed(nullptr), m_lastTick(0)
+    {
+    }
+
+    SpatialTracker::~SpatialTracker()
+    {
+        Untrack();
+    }
+
+    void SpatialTracker::Track(EntityList& entityList)
+    {
+        Untrack();
+
+        m_entityList = &entityList;
+        m_removed = &entityList.CreateObserver<OnRemoved<Transform>, OnRemoved<SpatialBody>>();
+
+        // writes made in place through a reference never reach an observer, only the change ticks see them
+        entityList.TrackChanges<Transform>();
+        entityList.TrackChanges<SpatialBody>();
+
+        entityList.ForEach<Transform, SpatialBody>(
+            [this](entt::entity entity, Transform& transform, SpatialBody& body) {
+                Set(static_cast<uint32_t>(entity), transform, body);
+            });
+
+        m_lastTick = entityList.ClaimChangeTick();
+    }
+
+    void SpatialTracker::Untrack()
+    {
+        if (!m_entityList)
+            return;
+
+        m_entityList->DestroyObserver(*m_removed);
+
+        m_entityList = nullptr;
+        m_removed = nullptr;
+    }
+
+    void SpatialTracker::Update(EntityList& entityList)
+    {
+        // removals come first so an entity that lost its body and got a new one is added back below
+        m_removed->Consume([this](uint32_t id) { m_index->Remove(id); });
+
+        auto set = [this](entt::entity entity, Transform& transform, SpatialBody& body) {
+            Set(static_cast<uint32_t>(entity), transform, body);
+        };
+
+        // an entity whose Transform and SpatialBody both changed is set twice, which leaves it the same
+        entityList.ForEach<Transform, SpatialBody>(Changed<Transform>{m_lastTick}, set);
+        entityList.ForEach<Transform, SpatialBody>(Changed<SpatialBody>{m_lastTick}, set);
+
+        m_lastTick = entityList.ClaimChangeTick();
+    }
+
+    const SpatialIndex& SpatialTracker::GetIndex() const
+    {
+        return *m_index;
+    }
+
+    void SpatialTracker::Set(uint32_t id, const Transform& transform, const SpatialBody& body)
+    {
+        const float scale =
+            std::max({std::abs(transform.scale.x), std::abs(transform.scale.y), std::abs(transform.scale.z)});
+        m_index->Set(id, transform.pos, body.radius * scale);
+    }
+} // namespace Fenrir
@@ -0,0 +1,326 @@
+#include "FenrirSpatial/UniformGrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace Fenrir
+{
+    UniformGrid::UniformGrid(float cellSize)
+        : m_cellSize(cellSize), m_inverseCellSize(1.0f / cellSize), m_entries(), m_slots(), m_cells(), m_large()
+    {
+    }
+
+    template <typename Func>
+    void UniformGrid::ForEachInCells(const Cell& min, const Cell& max, Func&& func) const
+    {
+        // a query bigger than the occupied part of the grid is cheaper to answer by looking at every entry
+        if (CellCount(min, max) > static_cast<int64_t>(m_cells.size()))
+        {
+            for (const Entry& entry : m_entries)
+            {
+                if (Overlaps(entry, min, max))
+                    func(entry);
+            }
+            return;
+        }
+
+        for (const uint32_t slot : m_large)
+        {
+            if (Overlaps(m_entries[slot], min, max))
+                func(m_entries[slot]);
+        }
+
+        for (int32_t x = min.x; x <= max.x; ++x)
+        {
+            for (int32_t y = min.y; y <= max.y; ++y)
+            {
+                for (int32_t z = min.z; z <= max.z; ++z)
+                {
+                    auto it = m_cells.find(KeyOf(Cell{x, y, z}));
+                    if (it == m_cells.end())
+                        continue;
+
+                    for (const uint32_t slot : it->second)
+                    {
+                        const Entry& entry = m_entries[slot];
+
+                        // an entry in several cells is only visited from the first of them inside the query
+                        if (std::max(entry.min.x, min.x) == x && std::max(entry.min.y, min.y) == y &&
+                            std::max(entry.min.z, min.z) == z)
+                            func(entry);
+                    }
+                }
+            }
+        }
+    }
+
+    void UniformGrid::Set(uint32_t id, const Math::Point& center, float radius)
+    {
+        const Cell min = CellOf(center - Math::Vec3(radius));
+        const Cell max = CellOf(center + Math::Vec3(radius));
+
+        auto it = m_slots.find(id);
+        if (it != m_slots.end())
+        {
+            Entry& entry = m_entries[it->second];
+            entry.center = center;
+            entry.radius = radius;
+
+            // most moves stay within the same cells, which needs nothing else
+            if (entry.min == min && entry.max == max)
+                return;
+
+            RemoveFromCells(it->second);
+            entry.min = min;
+            entry.max = max;
+            AddToCells(it->second);
+            return;
+        }
+
+        const uint32_t slot = static_cast<uint32_t>(m_entries.size());
+        m_entries.push_back({id, center, radius, min, max, NotLarge});
+        m_slots.emplace(id, slot);
+        AddToCells(slot);
+    }
+
+    void UniformGrid::Remove(uint32_t id)
+    {
+        auto it = m_slots.find(id);
+        if (it == m_slots.end())
+            return;
+
+        const uint32_t slot = it->second;
+        const uint32_t last = static_cast<uint32_t>(m_entries.size() - 1);
+        RemoveFromCells(slot);
+        m_slots.erase(it);
+
+        // fill the gap with the last entry so the entries stay packed
+        if (slot != last)
+        {
+            RelinkInCells(last, slot);
+            m_entries[slot] = m_entries[last];
+            m_slots[m_entries[slot].id] = slot;
+        }
+
+        m_entries.pop_back();
+    }
+
+    bool UniformGrid::Contains(uint32_t id) const
+    {
+        return m_slots.contains(id);
+    }
+
+    void UniformGrid::Clear()
+    {
+        m_entries.clear();
+        m_slots.clear();
+        m_cells.clear();
+        m_large.clear();
+    }
+
+    size_t UniformGrid::GetCount() const
+    {
+        return m_entries.size();
+    }
+
+    void UniformGrid::GetIds(std::vector<uint32_t>& ids) const
+    {
+        for (const Entry& entry : m_entries)
+            ids.push_back(entry.id);
+    }
+
+    void UniformGrid::QueryRadius(const Math::Point& center, float radius, std::vector<uint32_t>& results) const
+    {
+        const Cell min = CellOf(center - Math::Vec3(radius));
+        const Cell max = CellOf(center + Math::Vec3(radius));
+
+        ForEachInCells(min, max, [&](const Entry& entry) {
+            if (SpheresOverlap(center, radius, entry.center, entry.radius))
+                results.push_back(entry.id);
+        });
+    }
+
+    void UniformGrid::QueryAABB(const Math::AABB& box, std::vector<uint32_t>& results) const
+    {
+        ForEachInCells(CellOf(box.min), CellOf(box.max), [&](const Entry& entry) {
+            if (SphereOverlapsAABB(entry.center, entry.radius, box))
+                results.push_back(entry.id);
+        });
+    }
+
+    void UniformGrid::QueryRay(const Math::Ray& ray, float maxDistance, std::vector<uint32_t>& results) const
+    {
+        std::vector<std::pair<float, uint32_t>> hits;
+
+        // walk the cells the ray passes through in order, an entry listed in several of them is hit from each so
+        // only its nearest hit is kept
+        const Cell start = CellOf(ray.origin);
+        int32_t cell[3] = {start.x, start.y, start.z};
+        int32_t step[3];
+        float next[3];
+        float delta[3];
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            const float dir = ray.dir[axis];
+            if (dir > 0.0f)
+            {
+                step[axis] = 1;
+                next[axis] = ((static_cast<float>(cell[axis]) + 1.0f) * m_cellSize - ray.origin[axis]) / dir;
+                delta[axis] = m_cellSize / dir;
+            }
+            else if (dir < 0.0f)
+            {
+                step[axis] = -1;
+                next[axis] = (static_cast<float>(cell[axis]) * m_cellSize - ray.origin[axis]) / dir;
+                delta[axis] = -m_cellSize / dir;
+            }
+            else
+            {
+                step[axis] = 0;
+                next[axis] = std::numeric_limits<float>::infinity();
+                delta[axis] = std::numeric_limits<float>::infinity();
+            }
+        }
+
+        for (const uint32_t slot : m_large)
+        {
+            const Entry& entry = m_entries[slot];
+            float distance;
+            if (RayHitsSphere(ray, maxDistance, entry.center, entry.radius, distance))
+                hits.emplace_back(distance, entry.id);
+        }
+
+        float travelled = 0.0f;
+        while (travelled <= maxDistance)
+        {
+            auto it = m_cells.find(KeyOf(Cell{cell[0], cell[1], cell[2]}));
+            if (it != m_cells.end())
+            {
+                for (const uint32_t slot : it->second)
+                {
+                    const Entry& entry = m_entries[slot];
+                    float distance;
+                    if (RayHitsSphere(ray, maxDistance, entry.center, entry.radius, distance))
+                        hits.emplace_back(distance, entry.id);
+                }
+            }
+
+            const int axis = (next[0] < next[1]) ? (next[0] < next[2] ? 0 : 2) : (next[1] < next[2] ? 1 : 2);
+            travelled = next[axis];
+            next[axis] += delta[axis];
+            cell[axis] += step[axis];
+        }
+
+        // order by id then distance so the first hit of each id is its nearest, then order what is left by distance
+        std::sort(hits.begin(), hits.end(), [](const auto& a, const auto& b) {
+            return a.second != b.second ? a.second < b.second : a.first < b.first;
+        });
+        auto sameId = [](const auto& a, const auto& b) { return a.second == b.second; };
+        hits.erase(std::unique(hits.begin(), hits.end(), sameId), hits.end());
+        std::sort(hits.begin(), hits.end());
+
+        for (const auto& hit : hits)
+            results.push_back(hit.second);
+    }
+
+    float UniformGrid::GetCellSize() const
+    {
+        return m_cellSize;
+    }
+
+    UniformGrid::Cell UniformGrid::CellOf(const Math::Point& point) const
+    {
+        return Cell{static_cast<int32_t>(std::floor(point.x * m_inverseCellSize)),
+                    static_cast<int32_t>(std::floor(point.y * m_inverseCellSize)),
+                    static_cast<int32_t>(std::floor(point.z * m_inverseCellSize))};
+    }
+
+    uint64_t UniformGrid::KeyOf(const Cell& cell)
+    {
+        // 21 bits per axis, cells further than a million apart share keys which only costs extra candidates
+        constexpr uint64_t mask = (1ull << 21) - 1;
+        return ((static_cast<uint64_t>(cell.x) & mask) << 42) | ((static_cast<uint64_t>(cell.y) & mask) << 21) |
+               (static_cast<uint64_t>(cell.z) & mask);
+    }
+
+    int64_t UniformGrid::CellCount(const Cell& min, const Cell& max)
+    {
+        return (int64_t(max.x) - min.x + 1) * (int64_t(max.y) - min.y + 1) * (int64_t(max.z) - min.z + 1);
+    }
+
+    bool UniformGrid::Overlaps(const Entry& entry, const Cell& min, const Cell& max)
+    {
+        return entry.max.x >= min.x && entry.min.x <= max.x && entry.max.y >= min.y && entry.min.y <= max.y &&
+               entry.max.z >= min.z && entry.min.z <= max.z;
+    }
+
+    void UniformGrid::AddToCells(uint32_t slot)
+    {
+        Entry& entry = m_entries[slot];
+        if (CellCount(entry.min, entry.max) > MaxCellsPerEntry)
+        {
+            entry.large = static_cast<uint32_t>(m_large.size());
+            m_large.push_back(slot);
+            return;
+        }
+
+        entry.large = NotLarge;
+        for (int32_t x = entry.min.x; x <= entry.max.x; ++x)
+            for (int32_t y = entry.min.y; y <= entry.max.y; ++y)
+                for (int32_t z = entry.min.z; z <= entry.max.z; ++z)
+                    m_cells[KeyOf(Cell{x, y, z})].push_back(slot);
+    }
+
+    void UniformGrid::RemoveFromCells(uint32_t slot)
+    {
+        const Entry& entry = m_entries[slot];
+        if (entry.large != NotLarge)
+        {
+            m_large[entry.large] = m_large.back();
+            m_entries[m_large[entry.large]].large = entry.large;
+            m_large.pop_back();
+            return;
+        }
+
+        for (int32_t x = entry.min.x; x <= entry.max.x; ++x)
+        {
+            for (int32_t y = entry.min.y; y <= entry.max.y; ++y)
+            {
+                for (int32_t z = entry.min.z; z <= entry.max.z; ++z)
+                {
+                    auto it = m_cells.find(KeyOf(Cell{x, y, z}));
+                    std::vector<uint32_t>& slots = it->second;
+                    *std::find(slots.begin(), slots.end(), slot) = slots.back();
+                    slots.pop_back();
+
+                    if (slots.empty())
+                        m_cells.erase(it);
+                }
+            }
+        }
+    }
+
+    void UniformGrid::RelinkInCells(uint32_t from, uint32_t to)
+    {
+        const Entry& entry = m_entries[from];
+        if (entry.large != NotLarge)
+        {
+            m_large[entry.large] = to;
+            return;
+        }
+
+        for (int32_t x = entry.min.x; x <= entry.max.x; ++x)
+        {
+            for (int32_t y = entry.min.y; y <= entry.max.y; ++y)
+            {
+                for (int32_t z = entry.min.z; z <= entry.max.z; ++z)
+                {
+                    std::vector<uint32_t>& slots = m_cells[KeyOf(Cell{x, y, z})];
+                    *std::find(slots.begin(), slots.end(), from) = to;
+                }
+            }
+        }
+    }
+} // namespace Fenrir
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdio>
+
+namespace Fenrir::Test
+{
+    /**
+     * @brief Get the number of checks that have failed so far, a test returns non zero from main if any did
+     *
+     * @return int& the number of failed checks
+     */
+    inline int& Failures()
+    {
+        static int failures = 0;
+        return failures;
+    }
+} // namespace Fenrir::Test
+
+// reports a failed condition and carries on, so one run shows every check that fails
+#define FENRIR_CHECK(condition)                                                                                        \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (!(condition))                                                                                              \
+        {                                                                                                              \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition);                         \
+            ++Fenrir::Test::Failures();                                                                                \
+        }                                                                                                              \
+    } while (false)
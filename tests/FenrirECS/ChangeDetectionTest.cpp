@@ -0,0 +1,142 @@
+#include "Check.hpp"
+
+#include "FenrirECS/ChangeDetection.hpp"
+#include "FenrirECS/Entity.hpp"
+#include "FenrirECS/EntityList.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+    using namespace Fenrir;
+
+    struct Health
+    {
+        int value = 0;
+    };
+
+    template <typename Filter>
+    std::vector<uint32_t> Matching(EntityList& entityList, Filter filter)
+    {
+        std::vector<uint32_t> ids;
+        entityList.ForEach<Health>(filter, [&ids](entt::entity entity, Health&) {
+            ids.push_back(static_cast<uint32_t>(entity));
+        });
+
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    }
+
+    void ExistingComponentsAreStampedWhenTracked()
+    {
+        EntityList entityList;
+        entityList.CreateEntity().AddComponent<Health>(Health{1});
+        entityList.CreateEntity().AddComponent<Health>(Health{2});
+        entityList.TrackChanges<Health>();
+
+        // a system's first run starts from zero and sees everything, later runs only what came after their claim
+        FENRIR_CHECK(Matching(entityList, Changed<Health>{0}).size() == 2);
+        FENRIR_CHECK(Matching(entityList, Added<Health>{0}).size() == 2);
+
+        const uint32_t tick = entityList.ClaimChangeTick();
+        FENRIR_CHECK(Matching(entityList, Changed<Health>{tick}).empty());
+        FENRIR_CHECK(Matching(entityList, Added<Health>{tick}).empty());
+    }
+
+    void AddedAndChangedSinceClaim()
+    {
+        EntityList entityList;
+        entityList.TrackChanges<Health>();
+        Entity first = entityList.CreateEntity();
+        first.AddComponent<Health>(Health{1});
+
+        const uint32_t tick = entityList.ClaimChangeTick();
+        Entity second = entityList.CreateEntity();
+        second.AddComponent<Health>(Health{2});
+
+        FENRIR_CHECK(Matching(entityList, Added<Health>{tick}) == std::vector<uint32_t>{second.GetId()});
+        FENRIR_CHECK(Matching(entityList, Changed<Health>{tick}) == std::vector<uint32_t>{second.GetId()});
+
+        // a write through a reference is only seen once it is marked
+        first.GetComponent<Health>().value = 10;
+        FENRIR_CHECK(Matching(entityList, Changed<Health>{tick}).size() == 1);
+        entityList.MarkComponentChanged<Health>(first.GetId());
+        FENRIR_CHECK(Matching(entityList, Changed<Health>{tick}).size() == 2);
+        FENRIR_CHECK(Matching(entityList, Added<Health>{tick}).size() == 1);
+    }
+
+    void ReplacingRecordsAChange()
+    {
+        EntityList entityList;
+        entityList.TrackChanges<Health>();
+        Entity entity = entityList.CreateEntity();
+        entity.AddComponent<Health>(Health{1});
+
+        const uint32_t tick = entityList.ClaimChangeTick();
+        entity.AddComponent<Health>(Health{5});
+
+        FENRIR_CHECK(Matching(entityList, Changed<Health>{tick}).size() == 1);
+        FENRIR_CHECK(Matching(entityList, Added<Health>{tick}).empty());
+    }
+
+    void ClaimHidesTheSystemsOwnWrites()
+    {
+        EntityList entityList;
+        entityList.TrackChanges<Health>();
+        Entity entity = entityList.CreateEntity();
+        entity.AddComponent<Health>(Health{1});
+
+        // the system writes, then claims, so its next run does not see its own write
+        entity.GetComponent<Health>().value = 2;
+        entityList.MarkComponentChanged<Health>(entity.GetId());
+        const uint32_t tick = entityList.ClaimChangeTick();
+        FENRIR_CHECK(Matching(entityList, Changed<Health>{tick}).empty());
+
+        // a write made by anything else after the claim, even within the same phase, is newer
+        entityList.MarkComponentChanged<Health>(entity.GetId());
+        FENRIR_CHECK(Matching(entityList, Changed<Health>{tick}).size() == 1);
+
+        entityList.AdvanceChangeTick();
+        const uint32_t next = entityList.ClaimChangeTick();
+        FENRIR_CHECK(next > tick);
+        FENRIR_CHECK(Matching(entityList, Changed<Health>{next}).empty());
+    }
+
+    void FilteredViewMatchesForEach()
+    {
+        EntityList entityList;
+        entityList.TrackChanges<Health>();
+        std::vector<uint32_t> ids;
+        for (int i = 0; i < 8; ++i)
+        {
+            Entity entity = entityList.CreateEntity();
+            entity.AddComponent<Health>(Health{i});
+            ids.push_back(entity.GetId());
+        }
+
+        const uint32_t tick = entityList.ClaimChangeTick();
+        entityList.MarkComponentChanged<Health>(ids[2]);
+        entityList.MarkComponentChanged<Health>(ids[5]);
+
+        auto view = entityList.View<Health>(Changed<Health>{tick});
+        for (size_t i = 0; i < ids.size(); ++i)
+            FENRIR_CHECK(view.contains(static_cast<entt::entity>(ids[i])) == (i == 2 || i == 5));
+
+        size_t visited = 0;
+        view.each([&visited](Health&) { ++visited; });
+        FENRIR_CHECK(visited == 2);
+    }
+} // namespace
+
+int main()
+{
+    ExistingComponentsAreStampedWhenTracked();
+    AddedAndChangedSinceClaim();
+    ReplacingRecordsAChange();
+    ClaimHidesTheSystemsOwnWrites();
+    FilteredViewMatchesForEach();
+
+    return Fenrir::Test::Failures() == 0 ? 0 : 1;
+}
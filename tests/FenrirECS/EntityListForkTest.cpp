@@ -0,0 +1,123 @@
+#include "Check.hpp"
+
+#include "FenrirECS/Entity.hpp"
+#include "FenrirECS/EntityList.hpp"
+#include "FenrirECS/EntityListFork.hpp"
+#include "FenrirScheduler/ThreadPool.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+    using namespace Fenrir;
+
+    struct Id
+    {
+        uint32_t value = 0;
+    };
+
+    std::vector<uint32_t> CreateEntities(EntityList& entityList, size_t count)
+    {
+        std::vector<uint32_t> ids;
+        for (size_t i = 0; i < count; ++i)
+        {
+            Entity entity = entityList.CreateEntity();
+            entity.GetComponent<Transform>().pos.x = static_cast<float>(i);
+            entity.AddComponent<Id>(Id{entity.GetId()});
+            ids.push_back(entity.GetId());
+        }
+
+        return ids;
+    }
+
+    void RestorePutsBackEntitiesMadeBeforeTheFirstFork()
+    {
+        // nothing is tracked until the first fork, which has to pick up every entity created before it
+        EntityList entityList;
+        const std::vector<uint32_t> ids = CreateEntities(entityList, 5000);
+        entityList.SetName(ids[3], "three");
+        const EntityListFork fork = EntityListFork::Create(entityList);
+
+        entityList.DestroyEntity(ids[20]);
+        const uint32_t created = entityList.CreateEntity().GetId();
+        entityList.GetEntity(ids[10]).GetComponent<Transform>().pos.x = -1.0f;
+        entityList.MarkComponentChanged<Transform>(ids[10]);
+        entityList.SetName(ids[3], "changed");
+
+        fork.Restore(entityList);
+
+        FENRIR_CHECK(entityList.HasEntity(ids[20]));
+        FENRIR_CHECK(!entityList.HasEntity(created) || created == ids[20]);
+        FENRIR_CHECK(entityList.GetEntity(ids[10]).GetComponent<Transform>().pos.x == 10.0f);
+        FENRIR_CHECK(entityList.GetEntity(ids[20]).GetComponent<Transform>().pos.x == 20.0f);
+        FENRIR_CHECK(entityList.FindEntityByName("three").IsValid());
+
+        size_t transforms = 0;
+        entityList.ForEach<Transform>([&transforms](Transform&) { ++transforms; });
+        FENRIR_CHECK(transforms == ids.size());
+    }
+
+    void ForkOnlyCopiesMarkedPages()
+    {
+        EntityList entityList;
+        const std::vector<uint32_t> ids = CreateEntities(entityList, 5000);
+        const EntityListFork first = EntityListFork::Create(entityList);
+        FENRIR_CHECK(first.GetCopiedPageCount() == first.GetPageCount());
+
+        const EntityListFork unchanged = EntityListFork::Create(entityList, &first);
+        FENRIR_CHECK(unchanged.GetCopiedPageCount() == 0);
+
+        entityList.GetEntity(ids[10]).GetComponent<Transform>().pos.x = -1.0f;
+        entityList.MarkComponentChanged<Transform>(ids[10]);
+        const EntityListFork changed = EntityListFork::Create(entityList, &unchanged);
+        FENRIR_CHECK(changed.GetCopiedPageCount() > 0);
+        FENRIR_CHECK(changed.GetCopiedPageCount() < changed.GetPageCount());
+
+        // restoring in place only writes back the marked pages, after which nothing differs from the fork
+        entityList.GetEntity(ids[10]).GetComponent<Transform>().pos.x = -2.0f;
+        entityList.MarkComponentChanged<Transform>(ids[10]);
+        FENRIR_CHECK(changed.Restore(entityList));
+        FENRIR_CHECK(entityList.GetEntity(ids[10]).GetComponent<Transform>().pos.x == -1.0f);
+        FENRIR_CHECK(EntityListFork::Create(entityList, &changed).GetCopiedPageCount() == 0);
+    }
+
+    void ParallelMarksAreForked()
+    {
+        ThreadPool threadPool(4);
+        EntityList entityList;
+        entityList.SetThreadPool(&threadPool);
+        const std::vector<uint32_t> ids = CreateEntities(entityList, 20000);
+        const EntityListFork before = EntityListFork::Create(entityList);
+
+        // every page is marked from the pool's worker threads, none of which may resize the marks
+        entityList.ParallelForEach<Id, Transform>(
+            [&entityList](Id& id, Transform& transform) {
+                transform.pos.y = 1.0f;
+                entityList.MarkComponentChanged<Transform>(id.value);
+            },
+            256);
+
+        const EntityListFork after = EntityListFork::Create(entityList, &before);
+        FENRIR_CHECK(after.GetCopiedPageCount() > 0);
+
+        FENRIR_CHECK(before.Restore(entityList));
+        size_t restored = 0;
+        entityList.ForEach<Transform>([&restored](Transform& transform) { restored += transform.pos.y == 0.0f; });
+        FENRIR_CHECK(restored == ids.size());
+
+        FENRIR_CHECK(after.Restore(entityList));
+        size_t moved = 0;
+        entityList.ForEach<Transform>([&moved](Transform& transform) { moved += transform.pos.y == 1.0f; });
+        FENRIR_CHECK(moved == ids.size());
+    }
+} // namespace
+
+int main()
+{
+    RestorePutsBackEntitiesMadeBeforeTheFirstFork();
+    ForkOnlyCopiesMarkedPages();
+    ParallelMarksAreForked();
+
+    return Fenrir::Test::Failures() == 0 ? 0 : 1;
+}
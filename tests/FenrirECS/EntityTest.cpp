@@ -0,0 +1,108 @@
+#include "Check.hpp"
+
+#include "FenrirECS/Entity.hpp"
+#include "FenrirECS/EntityList.hpp"
+
+#include <vector>
+
+namespace
+{
+    using namespace Fenrir;
+
+    struct Health
+    {
+        int value = 0;
+    };
+
+    void LookupKeepsComponentData()
+    {
+        EntityList entityList;
+        Entity entity = entityList.CreateEntity();
+        entity.GetComponent<Transform>().pos = Math::Vec3(1.0f, 2.0f, 3.0f);
+        entityList.SetName(entity.GetId(), "player");
+
+        const Transform* transform = &entity.GetComponent<Transform>();
+        for (int i = 0; i < 100; ++i)
+        {
+            Entity lookedUp = entityList.GetEntity(entity.GetId());
+            Entity handle(entity.GetId(), &entityList);
+            FENRIR_CHECK(lookedUp.IsValid() && handle.IsValid());
+        }
+
+        // the component was neither reset nor moved to another slot
+        FENRIR_CHECK(&entity.GetComponent<Transform>() == transform);
+        FENRIR_CHECK(entity.GetComponent<Transform>().pos.y == 2.0f);
+        FENRIR_CHECK(entity.GetComponent<Name>().Get() == "player");
+    }
+
+    void LookupFiresNoSignals()
+    {
+        EntityList entityList;
+        std::vector<uint32_t> ids;
+        for (int i = 0; i < 10; ++i)
+            ids.push_back(entityList.CreateEntity().GetId());
+
+        // an observer sees every add, replace and remove of the default components made through the registry
+        Observer& observer = entityList.CreateObserver<OnAdded<Transform>, OnUpdated<Transform>, OnRemoved<Transform>,
+                                                       OnAdded<Name>, OnUpdated<Name>, OnRemoved<Name>>();
+        entityList.TrackChanges<Transform>();
+        const uint32_t tick = entityList.ClaimChangeTick();
+
+        for (const uint32_t id : ids)
+        {
+            Entity entity = entityList.GetEntity(id);
+            FENRIR_CHECK(entity.HasComponent<Transform>() && entity.HasComponent<Name>());
+            Entity(id, &entityList).GetComponent<Transform>();
+        }
+
+        FENRIR_CHECK(observer.IsEmpty());
+
+        size_t changed = 0;
+        entityList.ForEach<Transform>(Changed<Transform>{tick}, [&changed](Transform&) { ++changed; });
+        FENRIR_CHECK(changed == 0);
+    }
+
+    void HandleOfMissingEntityAddsNothing()
+    {
+        EntityList entityList;
+        Entity entity = entityList.CreateEntity();
+        const uint32_t id = entity.GetId();
+        entityList.DestroyEntity(id);
+
+        // a handle to a destroyed entity is invalid and does not bring it or its components back
+        Entity handle(id, &entityList);
+        FENRIR_CHECK(!handle.IsValid());
+        FENRIR_CHECK(!entityList.GetEntity(id).IsValid());
+
+        size_t transforms = 0;
+        entityList.ForEach<Transform>([&transforms](Transform&) { ++transforms; });
+        FENRIR_CHECK(transforms == 0);
+    }
+
+    void AddComponentReplacesInPlace()
+    {
+        EntityList entityList;
+        Entity first = entityList.CreateEntity();
+        Entity second = entityList.CreateEntity();
+        first.AddComponent<Health>(Health{10});
+        second.AddComponent<Health>(Health{20});
+
+        Health* slot = &first.GetComponent<Health>();
+        first.AddComponent<Health>(Health{30});
+
+        // replacing keeps the slot, removing and re-adding would have swapped it with the last one
+        FENRIR_CHECK(&first.GetComponent<Health>() == slot);
+        FENRIR_CHECK(first.GetComponent<Health>().value == 30);
+        FENRIR_CHECK(second.GetComponent<Health>().value == 20);
+    }
+} // namespace
+
+int main()
+{
+    LookupKeepsComponentData();
+    LookupFiresNoSignals();
+    HandleOfMissingEntityAddsNothing();
+    AddComponentReplacesInPlace();
+
+    return Fenrir::Test::Failures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+#include "Check.hpp"
+
+#include "FenrirECS/Entity.hpp"
+#include "FenrirECS/EntityList.hpp"
+#include "FenrirECS/Snapshot.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using namespace Fenrir;
+
+    struct Health
+    {
+        int value = 0;
+    };
+
+    struct Unsaved
+    {
+        int value = 0;
+    };
+
+    std::string TempPath(const char* name)
+    {
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+
+    SnapshotSchema MakeSchema()
+    {
+        SnapshotSchema schema = SnapshotSchema::Default();
+        schema.Register<Health>("Health");
+        return schema;
+    }
+
+    void RoundTripKeepsEntitiesAndComponents()
+    {
+        const SnapshotSchema schema = MakeSchema();
+        const std::string path = TempPath("FenrirSnapshotRoundTrip.bin");
+
+        EntityList saved;
+        std::vector<uint32_t> ids;
+        for (int i = 0; i < 1000; ++i)
+        {
+            Entity entity = saved.CreateEntity();
+            entity.GetComponent<Transform>().pos.x = static_cast<float>(i);
+            if (i % 2 == 0)
+                entity.AddComponent<Health>(Health{i * 10});
+            entity.AddComponent<Unsaved>(Unsaved{i});
+            ids.push_back(entity.GetId());
+        }
+        saved.SetName(ids[7], "seven");
+        FENRIR_CHECK(saved.SetParent(ids[1], ids[0]));
+
+        // a gap in the ids has to come back as a gap, not shift every later entity down
+        saved.DestroyEntity(ids[500]);
+
+        FENRIR_CHECK(Snapshot::Save(saved, path, schema));
+
+        EntityList loaded;
+        loaded.CreateEntity();
+        FENRIR_CHECK(Snapshot::Load(loaded, path, schema));
+
+        for (size_t i = 0; i < ids.size(); ++i)
+        {
+            if (i == 500)
+            {
+                FENRIR_CHECK(!loaded.HasEntity(ids[i]));
+                continue;
+            }
+
+            Entity entity = loaded.GetEntity(ids[i]);
+            FENRIR_CHECK(entity.IsValid());
+            FENRIR_CHECK(entity.GetComponent<Transform>().pos.x == static_cast<float>(i));
+            FENRIR_CHECK(entity.HasComponent<Health>() == (i % 2 == 0));
+            if (entity.HasComponent<Health>())
+                FENRIR_CHECK(entity.GetComponent<Health>().value == static_cast<int>(i) * 10);
+            FENRIR_CHECK(!entity.HasComponent<Unsaved>());
+        }
+
+        FENRIR_CHECK(loaded.FindEntityByName("seven").GetId() == ids[7]);
+        FENRIR_CHECK(loaded.GetEntity(ids[1]).GetComponent<Hierarchy>().parent == ids[0]);
+
+        // the entity made before loading was replaced rather than kept alongside the loaded ones
+        size_t transforms = 0;
+        loaded.ForEach<Transform>([&transforms](Transform&) { ++transforms; });
+        FENRIR_CHECK(transforms == ids.size() - 1);
+
+        std::filesystem::remove(path);
+    }
+
+    void SavedTwiceIsIdentical()
+    {
+        const std::string first = TempPath("FenrirSnapshotFirst.bin");
+        const std::string second = TempPath("FenrirSnapshotSecond.bin");
+
+        EntityList entityList;
+        for (int i = 0; i < 100; ++i)
+            entityList.CreateEntity().GetComponent<Transform>().pos.y = static_cast<float>(i);
+
+        FENRIR_CHECK(Snapshot::Save(entityList, first));
+        EntityList loaded;
+        FENRIR_CHECK(Snapshot::Load(loaded, first));
+        FENRIR_CHECK(Snapshot::Save(loaded, second));
+
+        std::ifstream lhs(first, std::ios::binary);
+        std::ifstream rhs(second, std::ios::binary);
+        const std::string lhsBytes((std::istreambuf_iterator<char>(lhs)), std::istreambuf_iterator<char>());
+        const std::string rhsBytes((std::istreambuf_iterator<char>(rhs)), std::istreambuf_iterator<char>());
+        FENRIR_CHECK(!lhsBytes.empty() && lhsBytes == rhsBytes);
+
+        std::filesystem::remove(first);
+        std::filesystem::remove(second);
+    }
+
+    void BadFilesLeaveTheListEmpty()
+    {
+        const std::string path = TempPath("FenrirSnapshotBad.bin");
+
+        EntityList entityList;
+        for (int i = 0; i < 100; ++i)
+            entityList.CreateEntity();
+        FENRIR_CHECK(Snapshot::Save(entityList, path));
+
+        // cut the file off part way through the columns
+        const std::uintmax_t size = std::filesystem::file_size(path);
+        std::filesystem::resize_file(path, size / 2);
+
+        EntityList loaded;
+        loaded.CreateEntity();
+        FENRIR_CHECK(!Snapshot::Load(loaded, path));
+        size_t transforms = 0;
+        loaded.ForEach<Transform>([&transforms](Transform&) { ++transforms; });
+        FENRIR_CHECK(transforms == 0);
+
+        // a file that is not a snapshot at all
+        {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file << "not a snapshot, just some text that is long enough to hold a header";
+        }
+        FENRIR_CHECK(!Snapshot::Load(loaded, path));
+
+        FENRIR_CHECK(!Snapshot::Load(loaded, TempPath("FenrirSnapshotMissing.bin")));
+
+        std::filesystem::remove(path);
+    }
+} // namespace
+
+int main()
+{
+    RoundTripKeepsEntitiesAndComponents();
+    SavedTwiceIsIdentical();
+    BadFilesLeaveTheListEmpty();
+
+    return Fenrir::Test::Failures() == 0 ? 0 : 1;
+}
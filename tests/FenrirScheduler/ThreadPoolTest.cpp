@@ -0,0 +1,155 @@
+#include "Check.hpp"
+
+#include "FenrirScheduler/TaskCounter.hpp"
+#include "FenrirScheduler/ThreadPool.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+namespace
+{
+    // every allocation made anywhere in the process while counting is on
+    std::atomic<bool> s_counting = false;
+    std::atomic<size_t> s_allocations = 0;
+
+    void* Allocate(size_t size)
+    {
+        if (s_counting.load(std::memory_order_relaxed))
+            s_allocations.fetch_add(1, std::memory_order_relaxed);
+
+        if (void* memory = std::malloc(size ? size : 1))
+            return memory;
+
+        throw std::bad_alloc();
+    }
+} // namespace
+
+void* operator new(size_t size)
+{
+    return Allocate(size);
+}
+
+void* operator new[](size_t size)
+{
+    return Allocate(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+namespace
+{
+    using namespace Fenrir;
+
+    void DispatchDoesNotAllocate()
+    {
+        ThreadPool pool(4);
+        TaskCounter counter;
+        std::atomic<size_t> ran = 0;
+
+        auto round = [&] {
+            for (size_t i = 0; i < 256; ++i)
+                pool.Dispatch([&ran] { ran.fetch_add(1, std::memory_order_relaxed); }, counter);
+            pool.Wait(counter);
+        };
+
+        // the first round lets anything lazily set up on first use happen before counting
+        round();
+
+        s_allocations = 0;
+        s_counting = true;
+        for (size_t i = 0; i < 100; ++i)
+            round();
+        s_counting = false;
+
+        FENRIR_CHECK(s_allocations.load() == 0);
+        FENRIR_CHECK(ran.load() == 101 * 256);
+    }
+
+    void NestedDispatchDoesNotAllocate()
+    {
+        ThreadPool pool(4);
+        std::atomic<size_t> ran = 0;
+
+        auto round = [&] {
+            TaskCounter outer;
+            for (size_t i = 0; i < 16; ++i)
+            {
+                pool.Dispatch(
+                    [&pool, &ran] {
+                        TaskCounter inner;
+                        for (size_t j = 0; j < 16; ++j)
+                            pool.Dispatch([&ran] { ran.fetch_add(1, std::memory_order_relaxed); }, inner);
+                        pool.Wait(inner);
+                    },
+                    outer);
+            }
+            pool.Wait(outer);
+        };
+
+        round();
+
+        s_allocations = 0;
+        s_counting = true;
+        for (size_t i = 0; i < 100; ++i)
+            round();
+        s_counting = false;
+
+        FENRIR_CHECK(s_allocations.load() == 0);
+        FENRIR_CHECK(ran.load() == 101 * 16 * 16);
+    }
+
+    void FullQueuesNeverRunOnCaller()
+    {
+        ThreadPool pool(2);
+        TaskCounter counter;
+        std::mutex mutex;
+        std::atomic<size_t> ran = 0;
+
+        // the tasks need the lock the caller holds while dispatching, running one inline would deadlock
+        const size_t count = ThreadPool::QueueCapacity * pool.GetThreadCount() * 2;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (size_t i = 0; i < count; ++i)
+            {
+                pool.Dispatch(
+                    [&mutex, &ran] {
+                        std::lock_guard<std::mutex> taskLock(mutex);
+                        ran.fetch_add(1, std::memory_order_relaxed);
+                    },
+                    counter);
+            }
+        }
+        pool.Wait(counter);
+
+        FENRIR_CHECK(ran.load() == count);
+    }
+} // namespace
+
+int main()
+{
+    DispatchDoesNotAllocate();
+    NestedDispatchDoesNotAllocate();
+    FullQueuesNeverRunOnCaller();
+
+    return Fenrir::Test::Failures() == 0 ? 0 : 1;
+}